@@ -0,0 +1,277 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisopipeline.h"
+#include "uaisoprotocol.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QSharedMemory>
+#include <QTimer>
+
+#include <iostream>
+#include <unordered_map>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+// The out-of-process analyser: parsing, binding, type checking, symbol
+// collection and completion run here instead of inside the IDE. Requests
+// arrive over a local socket, results go back through shared memory.
+
+using namespace UaisoQtc;
+using namespace Protocol;
+
+namespace {
+
+// A segment nobody released in this long is assumed abandoned.
+const int kSegmentLifetime = 60000;
+
+} // anonymous
+
+class AnalyserServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    AnalyserServer();
+    ~AnalyserServer();
+
+    bool listen(const QString& serverName);
+
+private slots:
+    void newConnection();
+    void readRequests();
+    void socketGone();
+    void sweep();
+
+private:
+    struct Segment
+    {
+        QSharedMemory* m_memory { nullptr };
+        QLocalSocket* m_owner { nullptr };
+        QElapsedTimer m_age;
+    };
+
+    AnalysisPipeline* pipeline(const Message& request);
+    QByteArray handle(const Message& request);
+    void reply(QLocalSocket* socket, quint32 id, const QByteArray& data);
+
+    QLocalServer m_server;
+    std::unordered_map<int, std::unique_ptr<AnalysisPipeline>> m_pipelines;
+    std::unordered_map<int, QStringList> m_searchPaths;
+    QHash<QString, Segment> m_shared;
+    quint32 m_nextShared { 0 };
+    QTimer m_sweeper;
+};
+
+AnalyserServer::AnalyserServer()
+{
+    // Segments are normally released by the plugin, but a reply it never
+    // read (a dropped connection, a timed out completion) would leak.
+    m_sweeper.setInterval(kSegmentLifetime);
+    connect(&m_sweeper, SIGNAL(timeout()), this, SLOT(sweep()));
+    m_sweeper.start();
+}
+
+AnalyserServer::~AnalyserServer()
+{
+    for (const Segment& segment : m_shared)
+        delete segment.m_memory;
+}
+
+bool AnalyserServer::listen(const QString &serverName)
+{
+    QLocalServer::removeServer(serverName);
+    if (!m_server.listen(serverName))
+        return false;
+
+    connect(&m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+    return true;
+}
+
+void AnalyserServer::newConnection()
+{
+    while (QLocalSocket* socket = m_server.nextPendingConnection()) {
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequests()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(socketGone()));
+        connect(socket, SIGNAL(disconnected()), socket, SLOT(deleteLater()));
+    }
+}
+
+void AnalyserServer::socketGone()
+{
+    QObject* socket = sender();
+    for (auto it = m_shared.begin(); it != m_shared.end(); ) {
+        if (it->m_owner == socket) {
+            delete it->m_memory;
+            it = m_shared.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+void AnalyserServer::sweep()
+{
+    for (auto it = m_shared.begin(); it != m_shared.end(); ) {
+        if (it->m_age.hasExpired(kSegmentLifetime)) {
+            delete it->m_memory;
+            it = m_shared.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+AnalysisPipeline* AnalyserServer::pipeline(const Message &request)
+{
+    // A pipeline keeps its snapshot across requests, unless the search
+    // paths changed in the meantime.
+    auto& pipeline = m_pipelines[request.m_lang];
+    if (!pipeline || m_searchPaths[request.m_lang] != request.m_searchPaths) {
+        pipeline.reset(new AnalysisPipeline(uaiso::LangId(request.m_lang),
+                                            request.m_searchPaths));
+        m_searchPaths[request.m_lang] = request.m_searchPaths;
+    }
+    return pipeline.get();
+}
+
+QByteArray AnalyserServer::handle(const Message &request)
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+
+    if (request.m_kind == MessageKind::Analyse) {
+        out << pipeline(request)->analyse(request.m_fileName,
+                                          request.m_code.toStdString());
+    } else {
+        out << proposeCompletions(pipeline(request)->factory(),
+                                  request.m_searchPaths,
+                                  request.m_code.toStdString(),
+                                  request.m_fileName,
+                                  request.m_line, request.m_col);
+    }
+
+    return data;
+}
+
+void AnalyserServer::reply(QLocalSocket *socket, quint32 id, const QByteArray &data)
+{
+    Message msg;
+    msg.m_id = id;
+    msg.m_kind = MessageKind::Failure;
+    msg.m_sharedKey = QString::fromLatin1("%1-%2").arg(m_server.serverName())
+                                                   .arg(++m_nextShared);
+    msg.m_size = data.size();
+
+    // The segment lives until the plugin says it's done reading it, its
+    // connection goes away, or it's swept.
+    QSharedMemory* shared = new QSharedMemory(msg.m_sharedKey);
+    if (shared->create(qMax(data.size(), 1))) {
+        shared->lock();
+        memcpy(shared->data(), data.constData(), data.size());
+        shared->unlock();
+        Segment& segment = m_shared[msg.m_sharedKey];
+        segment.m_memory = shared;
+        segment.m_owner = socket;
+        segment.m_age.start();
+        msg.m_kind = MessageKind::Result;
+    } else {
+        delete shared;
+    }
+
+    writeMessage(socket, msg);
+}
+
+void AnalyserServer::readRequests()
+{
+    QLocalSocket* socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket)
+        return;
+
+    // Take everything that's queued first: an analysis superseded by a later
+    // one of the same file is answered with a failure instead of being run.
+    QList<Message> requests;
+    QHash<QString, quint32> latest;
+    Message request;
+    while (readMessage(socket, &request)) {
+        if (request.m_kind == MessageKind::Analyse)
+            latest.insert(request.m_fileName, request.m_id);
+        requests.append(request);
+    }
+
+    for (const Message& request : requests) {
+        switch (request.m_kind) {
+        case MessageKind::Analyse:
+            if (latest.value(request.m_fileName) != request.m_id) {
+                Message superseded;
+                superseded.m_id = request.m_id;
+                superseded.m_kind = MessageKind::Failure;
+                writeMessage(socket, superseded);
+                break;
+            }
+            reply(socket, request.m_id, handle(request));
+            break;
+
+        case MessageKind::Complete:
+            reply(socket, request.m_id, handle(request));
+            break;
+
+        case MessageKind::Release:
+            delete m_shared.take(request.m_sharedKey).m_memory;
+            break;
+
+        default:
+            break;
+        }
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    if (app.arguments().size() != 2) {
+        std::cerr << "usage: uaisoanalyser <server-name>" << std::endl;
+        return 1;
+    }
+
+    AnalyserServer server;
+    if (!server.listen(app.arguments().at(1))) {
+        std::cerr << "uaisoanalyser: cannot listen" << std::endl;
+        return 1;
+    }
+
+    // Tell the plugin it can connect.
+    std::cout << "ready" << std::endl;
+
+    return app.exec();
+}
+
+#include "main.moc"
@@ -0,0 +1,31 @@
+QT = core network concurrent
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = uaisoanalyser
+
+LIBS += -L$$(UAISO_PATH) -lUaiSoEngine
+INCLUDEPATH += $$(UAISO_PATH)
+INCLUDEPATH += $$(UAISO_PATH)/External
+
+UAISOEDITOR_DIR = $$PWD/../../plugins/uaisoeditor
+INCLUDEPATH += $$UAISOEDITOR_DIR
+
+include(../../qtcreatortool.pri)
+
+HEADERS += \
+    $$UAISOEDITOR_DIR/uaisodependencies.h \
+    $$UAISOEDITOR_DIR/uaisointerner.h \
+    $$UAISOEDITOR_DIR/uaisoloader.h \
+    $$UAISOEDITOR_DIR/uaisomappedfile.h \
+    $$UAISOEDITOR_DIR/uaisopipeline.h \
+    $$UAISOEDITOR_DIR/uaisoprotocol.h
+
+SOURCES += \
+    main.cpp \
+    $$UAISOEDITOR_DIR/uaisodependencies.cpp \
+    $$UAISOEDITOR_DIR/uaisointerner.cpp \
+    $$UAISOEDITOR_DIR/uaisoloader.cpp \
+    $$UAISOEDITOR_DIR/uaisomappedfile.cpp \
+    $$UAISOEDITOR_DIR/uaisopipeline.cpp \
+    $$UAISOEDITOR_DIR/uaisoprotocol.cpp
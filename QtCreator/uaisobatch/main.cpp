@@ -0,0 +1,350 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisodependencies.h"
+#include "uaisoloader.h"
+#include "uaisomappedfile.h"
+#include "uaisopipeline.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QThreadPool>
+#include <QUrl>
+#include <QtConcurrentMap>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Ast/Ast.h>
+#include <Parsing/Diagnostic.h>
+#include <Parsing/Factory.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Environment.h>
+#include <Semantic/Program.h>
+
+// Headless analysis of a source tree: the same parse, bind, dependencies
+// and type checking sequence as the editor, over every file, with
+// diagnostics written as JSON or SARIF.
+
+using namespace UaisoQtc;
+
+namespace {
+
+struct FileJob
+{
+    QString m_fileName;
+    uaiso::LangId m_lang;
+    int m_lines { 0 };
+    uaiso::LexemeMap m_lexemes;
+    uaiso::TokenMap m_tokens;
+    std::unique_ptr<uaiso::Unit> m_unit;
+    std::unique_ptr<uaiso::DiagnosticReports> m_reports;
+    std::unique_ptr<uaiso::Program> m_prog;
+    QVector<DiagnosticEntry> m_diagnostics;
+};
+
+// What files of a language share: the snapshot and whatever is needed to
+// bring dependencies into it.
+struct LangContext
+{
+    std::unique_ptr<uaiso::Factory> m_factory;
+    uaiso::TokenMap m_tokens;
+    uaiso::LexemeMap m_lexemes;
+    uaiso::Snapshot m_snapshot;
+    ModuleStore m_modules;
+    std::unique_ptr<DependencyManager> m_deps;
+};
+
+QStringList collectFiles(const QStringList& paths)
+{
+    QStringList files;
+    uaiso::LangId lang;
+    for (const QString& path : paths) {
+        const QFileInfo info(path);
+        if (info.isFile()) {
+            if (langIdForFile(path, &lang))
+                files.append(info.absoluteFilePath());
+            continue;
+        }
+        QDirIterator it(path, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString& file = it.next();
+            if (langIdForFile(file, &lang))
+                files.append(QFileInfo(file).absoluteFilePath());
+        }
+    }
+    files.removeDuplicates();
+    return files;
+}
+
+void parseAndBind(FileJob* job, uaiso::Factory* factory)
+{
+    MappedFile file(job->m_fileName);
+    if (!file.isValid())
+        return;
+
+    const std::string code = file.toStdString();
+    file.release();
+    job->m_lines = static_cast<int>(std::count(code.begin(), code.end(), '\n')) + 1;
+
+    job->m_unit = parseSource(factory, job->m_fileName, code,
+                              &job->m_tokens, &job->m_lexemes, &job->m_reports);
+    uaiso::ProgramAst* progAst = Program_Cast(job->m_unit->ast());
+    if (progAst) {
+        job->m_prog = bindProgram(factory, progAst, job->m_fileName,
+                                  &job->m_tokens, &job->m_lexemes, job->m_reports.get());
+    }
+}
+
+QJsonObject toJson(const FileJob& job)
+{
+    QJsonArray diagnostics;
+    for (const DiagnosticEntry& diagnostic : job.m_diagnostics) {
+        QJsonObject entry;
+        entry.insert(QLatin1String("line"), diagnostic.m_line + 1);
+        entry.insert(QLatin1String("column"), diagnostic.m_col + 1);
+        entry.insert(QLatin1String("endColumn"), diagnostic.m_lastCol + 1);
+        entry.insert(QLatin1String("severity"), diagnostic.m_warning ? QLatin1String("warning")
+                                                                     : QLatin1String("error"));
+        entry.insert(QLatin1String("message"), diagnostic.m_desc);
+        diagnostics.append(entry);
+    }
+
+    QJsonObject file;
+    file.insert(QLatin1String("file"), job.m_fileName);
+    file.insert(QLatin1String("diagnostics"), diagnostics);
+    return file;
+}
+
+QJsonDocument toSarif(const std::vector<std::unique_ptr<FileJob>>& jobs)
+{
+    QJsonArray results;
+    for (const auto& job : jobs) {
+        for (const DiagnosticEntry& diagnostic : job->m_diagnostics) {
+            QJsonObject region;
+            region.insert(QLatin1String("startLine"), diagnostic.m_line + 1);
+            region.insert(QLatin1String("startColumn"), diagnostic.m_col + 1);
+            region.insert(QLatin1String("endColumn"), diagnostic.m_lastCol + 1);
+
+            QJsonObject artifact;
+            artifact.insert(QLatin1String("uri"),
+                            QUrl::fromLocalFile(job->m_fileName).toString());
+
+            QJsonObject physical;
+            physical.insert(QLatin1String("artifactLocation"), artifact);
+            physical.insert(QLatin1String("region"), region);
+
+            QJsonObject location;
+            location.insert(QLatin1String("physicalLocation"), physical);
+
+            QJsonObject message;
+            message.insert(QLatin1String("text"), diagnostic.m_desc);
+
+            QJsonObject result;
+            result.insert(QLatin1String("ruleId"), QLatin1String("uaiso"));
+            result.insert(QLatin1String("level"), diagnostic.m_warning ? QLatin1String("warning")
+                                                                       : QLatin1String("error"));
+            result.insert(QLatin1String("message"), message);
+            result.insert(QLatin1String("locations"), QJsonArray() << location);
+            results.append(result);
+        }
+    }
+
+    QJsonObject driver;
+    driver.insert(QLatin1String("name"), QLatin1String("uaisobatch"));
+    driver.insert(QLatin1String("informationUri"), QLatin1String("https://github.com/ltcmelo/uaiso"));
+    QJsonObject tool;
+    tool.insert(QLatin1String("driver"), driver);
+
+    QJsonObject run;
+    run.insert(QLatin1String("tool"), tool);
+    run.insert(QLatin1String("results"), results);
+
+    QJsonObject sarif;
+    sarif.insert(QLatin1String("version"), QLatin1String("2.1.0"));
+    sarif.insert(QLatin1String("$schema"),
+                 QLatin1String("https://json.schemastore.org/sarif-2.1.0.json"));
+    sarif.insert(QLatin1String("runs"), QJsonArray() << run);
+    return QJsonDocument(sarif);
+}
+
+} // anonymous
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QLatin1String("uaisobatch"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QLatin1String("Analyse D, Go and Python sources with Uaiso."));
+    parser.addHelpOption();
+    QCommandLineOption formatOption(QStringList() << QLatin1String("f") << QLatin1String("format"),
+                                    QLatin1String("Output format, json or sarif."),
+                                    QLatin1String("format"), QLatin1String("json"));
+    QCommandLineOption outputOption(QStringList() << QLatin1String("o") << QLatin1String("output"),
+                                    QLatin1String("Write diagnostics to <file> (default: stdout)."),
+                                    QLatin1String("file"));
+    QCommandLineOption searchPathOption(QStringList() << QLatin1String("I") << QLatin1String("search-path"),
+                                        QLatin1String("Add <path> to where imports are looked up."),
+                                        QLatin1String("path"));
+    QCommandLineOption jobsOption(QStringList() << QLatin1String("j") << QLatin1String("jobs"),
+                                  QLatin1String("Number of threads (default: all cores)."),
+                                  QLatin1String("n"));
+    parser.addOption(formatOption);
+    parser.addOption(outputOption);
+    parser.addOption(searchPathOption);
+    parser.addOption(jobsOption);
+    parser.addPositionalArgument(QLatin1String("paths"),
+                                 QLatin1String("Files or directories to analyse."));
+    parser.process(app);
+
+    const QString format = parser.value(formatOption);
+    if (parser.positionalArguments().isEmpty()
+            || (format != QLatin1String("json") && format != QLatin1String("sarif"))) {
+        parser.showHelp(2);
+    }
+    if (parser.isSet(jobsOption))
+        QThreadPool::globalInstance()->setMaxThreadCount(parser.value(jobsOption).toInt());
+    const QStringList searchPaths = parser.values(searchPathOption);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    std::vector<std::unique_ptr<FileJob>> jobs;
+    std::unordered_map<int, std::unique_ptr<LangContext>> contexts;
+    for (const QString& fileName : collectFiles(parser.positionalArguments())) {
+        std::unique_ptr<FileJob> job(new FileJob);
+        job->m_fileName = fileName;
+        langIdForFile(fileName, &job->m_lang);
+        std::unique_ptr<LangContext>& context = contexts[static_cast<int>(job->m_lang)];
+        if (!context) {
+            context.reset(new LangContext);
+            context->m_factory = uaiso::FactoryCreator::create(job->m_lang);
+            context->m_deps.reset(new DependencyManager(context->m_factory.get(),
+                                                        &context->m_tokens,
+                                                        &context->m_lexemes,
+                                                        context->m_snapshot,
+                                                        &context->m_modules,
+                                                        searchPaths));
+            if (parser.isSet(jobsOption))
+                context->m_deps->loader()->setMaxThreadCount(parser.value(jobsOption).toInt());
+        }
+        jobs.push_back(std::move(job));
+    }
+
+    std::vector<FileJob*> work;
+    for (const auto& job : jobs)
+        work.push_back(job.get());
+    auto factoryOf = [&contexts](const FileJob* job) {
+        return contexts[static_cast<int>(job->m_lang)]->m_factory.get();
+    };
+
+    // Files are independent up until binding.
+    QtConcurrent::blockingMap(work, [&factoryOf](FileJob*& job) {
+        parseAndBind(job, factoryOf(job));
+    });
+
+    // Publish what's in the tree, then bring in what it imports from
+    // elsewhere (files already in the snapshot aren't loaded again).
+    QHash<FileJob*, QStringList> imports;
+    for (FileJob* job : work) {
+        if (!job->m_prog || job->m_prog->env().isEmpty())
+            continue;
+        imports.insert(job, importTargets(job->m_prog.get()));
+        contexts[static_cast<int>(job->m_lang)]->m_snapshot.insertOrReplace(
+                    job->m_fileName.toStdString(), std::move(job->m_prog));
+    }
+    for (auto it = imports.constBegin(); it != imports.constEnd(); ++it) {
+        contexts[static_cast<int>(it.key()->m_lang)]->m_deps->processDeps(
+                    it.key()->m_fileName, it.value());
+    }
+
+    // The snapshot is only read from now on.
+    QtConcurrent::blockingMap(work, [&factoryOf, &imports](FileJob*& job) {
+        uaiso::ProgramAst* progAst = job->m_unit ? Program_Cast(job->m_unit->ast()) : nullptr;
+        if (progAst && imports.contains(job)) {
+            typeCheck(factoryOf(job), progAst, &job->m_tokens, &job->m_lexemes,
+                      job->m_reports.get());
+        }
+        job->m_diagnostics = diagnosticEntries(job->m_reports.get());
+        job->m_unit.reset();
+    });
+
+    const qint64 elapsed = std::max<qint64>(timer.elapsed(), 1);
+
+    int lines = 0;
+    int errors = 0;
+    QJsonDocument output;
+    if (format == QLatin1String("sarif")) {
+        output = toSarif(jobs);
+    } else {
+        QJsonArray files;
+        for (const auto& job : jobs)
+            files.append(toJson(*job));
+        QJsonObject root;
+        root.insert(QLatin1String("files"), files);
+        output = QJsonDocument(root);
+    }
+    for (const auto& job : jobs) {
+        lines += job->m_lines;
+        for (const DiagnosticEntry& diagnostic : job->m_diagnostics)
+            errors += diagnostic.m_warning ? 0 : 1;
+    }
+
+    QFile out;
+    if (parser.isSet(outputOption)) {
+        out.setFileName(parser.value(outputOption));
+        if (!out.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "uaisobatch: cannot write " << qPrintable(out.fileName()) << std::endl;
+            return 2;
+        }
+    } else {
+        out.open(stdout, QIODevice::WriteOnly);
+    }
+    out.write(output.toJson());
+    out.close();
+
+    // Runs with -j 1 and without it give the speedup of the parallel passes.
+    const double seconds = elapsed / 1000.0;
+    std::cerr << jobs.size() << " files, " << lines << " lines in " << seconds << " s on "
+              << QThreadPool::globalInstance()->maxThreadCount() << " threads: "
+              << static_cast<qint64>(jobs.size() / seconds) << " files/s, "
+              << static_cast<qint64>(lines / seconds) << " lines/s" << std::endl;
+
+    return errors ? 1 : 0;
+}
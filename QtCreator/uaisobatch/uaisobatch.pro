@@ -0,0 +1,29 @@
+QT = core concurrent
+CONFIG += console
+CONFIG -= app_bundle
+
+TARGET = uaisobatch
+
+LIBS += -L$$(UAISO_PATH) -lUaiSoEngine
+INCLUDEPATH += $$(UAISO_PATH)
+INCLUDEPATH += $$(UAISO_PATH)/External
+
+UAISOEDITOR_DIR = $$PWD/../../plugins/uaisoeditor
+INCLUDEPATH += $$UAISOEDITOR_DIR
+
+include(../../qtcreatortool.pri)
+
+HEADERS += \
+    $$UAISOEDITOR_DIR/uaisodependencies.h \
+    $$UAISOEDITOR_DIR/uaisointerner.h \
+    $$UAISOEDITOR_DIR/uaisoloader.h \
+    $$UAISOEDITOR_DIR/uaisomappedfile.h \
+    $$UAISOEDITOR_DIR/uaisopipeline.h
+
+SOURCES += \
+    main.cpp \
+    $$UAISOEDITOR_DIR/uaisodependencies.cpp \
+    $$UAISOEDITOR_DIR/uaisointerner.cpp \
+    $$UAISOEDITOR_DIR/uaisoloader.cpp \
+    $$UAISOEDITOR_DIR/uaisomappedfile.cpp \
+    $$UAISOEDITOR_DIR/uaisopipeline.cpp
@@ -0,0 +1,185 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisochecker.h"
+
+#include <algorithm>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Ast/Ast.h>
+#include <Parsing/Diagnostic.h>
+#include <Parsing/Factory.h>
+#include <Parsing/LexemeMap.h>
+#include <Parsing/TokenMap.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Program.h>
+
+using namespace UaisoQtc;
+
+namespace {
+
+// Every top-level declaration is a chunk of its own.
+const int kDeclChunkSize = 0;
+
+} // anonymous
+
+IncrementalChecker::IncrementalChecker(uaiso::Factory* factory)
+    : m_factory(factory)
+    , m_chunker(factory)
+    , m_valid(false)
+    , m_signature(0)
+    , m_pendingSignature(0)
+{}
+
+bool IncrementalChecker::plan(const QStringList& lines)
+{
+    m_chunker.split(lines, kDeclChunkSize);
+    m_chunks = m_chunker.chunks();
+    m_prints.clear();
+    m_changed.clear();
+
+    QString signature = lines.mid(0, m_chunker.preambleEnd()).join(QLatin1Char('\n'));
+    int changedLines = 0;
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        const SourceChunk& chunk = m_chunks.at(i);
+        const QStringList& text =
+                lines.mid(chunk.m_firstLine, chunk.m_lastLine - chunk.m_firstLine + 1);
+        const quint64 print = contentHash(QString(), text.join(QLatin1Char('\n')));
+        m_prints.append(print);
+        signature += QLatin1Char('\n') + text.first();
+        if (!m_byPrint.contains(print)) {
+            m_changed.append(i);
+            changedLines += text.size();
+        }
+    }
+    m_pendingSignature = contentHash(QString(), signature);
+
+    // Checking edits alone takes parsing and binding them once more, it
+    // only pays off when they're a small part of the file.
+    return m_valid
+            && m_pendingSignature == m_signature
+            && changedLines * 2 < lines.size();
+}
+
+QVector<DiagnosticEntry> IncrementalChecker::checkChanged(const QString& fileName,
+                                                          const QStringList& lines,
+                                                          const QVector<DeclEntry>& decls)
+{
+    if (m_changed.isEmpty())
+        return commit();
+
+    uaiso::TokenMap tokens;
+    uaiso::LexemeMap lexemes;
+    std::unique_ptr<uaiso::DiagnosticReports> reports;
+    // The engine checks an AST, not part of one, changed declarations need
+    // the siblings they use around them or those would be undeclared.
+    const QVector<SourceChunk>& chunks = m_chunker.withReferenced(lines, m_changed, decls);
+    std::unique_ptr<uaiso::Unit> unit =
+            parseSource(m_factory, fileName, m_chunker.compose(lines, chunks),
+                        &tokens, &lexemes, &reports);
+    uaiso::ProgramAst* progAst = Program_Cast(unit->ast());
+    if (!progAst)
+        return commit(); // Changed declarations are retried next time.
+
+    std::unique_ptr<uaiso::Program> prog =
+            bindProgram(m_factory, progAst, fileName, &tokens, &lexemes, reports.get());
+    const int bound = diagnosticEntries(reports.get()).size();
+    typeCheck(m_factory, progAst, &tokens, &lexemes, reports.get());
+    const QVector<DiagnosticEntry>& diagnostics = diagnosticEntries(reports.get()).mid(bound);
+
+    for (int i : m_changed) {
+        const SourceChunk& chunk = m_chunks.at(i);
+        QVector<DiagnosticEntry> own;
+        for (DiagnosticEntry diagnostic : diagnostics) {
+            if (diagnostic.m_line < chunk.m_firstLine || diagnostic.m_line > chunk.m_lastLine)
+                continue;
+            diagnostic.m_line -= chunk.m_firstLine;
+            own.append(diagnostic);
+        }
+        m_byPrint.insert(m_prints.at(i), own);
+    }
+
+    return commit();
+}
+
+void IncrementalChecker::recordFull(const QVector<DiagnosticEntry>& diagnostics)
+{
+    QVector<QVector<DiagnosticEntry>> byChunk(m_chunks.size());
+    m_preamble.clear();
+    for (DiagnosticEntry diagnostic : diagnostics) {
+        auto chunk = std::upper_bound(m_chunks.begin(), m_chunks.end(), diagnostic.m_line,
+                                      [](int line, const SourceChunk& chunk) {
+            return line < chunk.m_firstLine;
+        });
+        if (chunk == m_chunks.begin()) {
+            m_preamble.append(diagnostic);
+            continue;
+        }
+        --chunk;
+        diagnostic.m_line -= chunk->m_firstLine;
+        byChunk[chunk - m_chunks.begin()].append(diagnostic);
+    }
+
+    // Identical declarations have identical diagnostics, keep the first.
+    m_byPrint.clear();
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        if (!m_byPrint.contains(m_prints.at(i)))
+            m_byPrint.insert(m_prints.at(i), byChunk.at(i));
+    }
+    m_signature = m_pendingSignature;
+    m_valid = true;
+}
+
+void IncrementalChecker::reset()
+{
+    m_valid = false;
+    m_preamble.clear();
+    m_byPrint.clear();
+}
+
+QVector<DiagnosticEntry> IncrementalChecker::commit()
+{
+    QVector<DiagnosticEntry> all = m_preamble;
+    QHash<quint64, QVector<DiagnosticEntry>> kept;
+    for (int i = 0; i < m_chunks.size(); ++i) {
+        const quint64 print = m_prints.at(i);
+        auto it = m_byPrint.constFind(print);
+        if (it == m_byPrint.constEnd())
+            continue;
+        for (DiagnosticEntry diagnostic : *it) {
+            diagnostic.m_line += m_chunks.at(i).m_firstLine;
+            all.append(diagnostic);
+        }
+        kept.insert(print, *it);
+    }
+
+    // Declarations that are gone are forgotten.
+    m_byPrint.swap(kept);
+    m_signature = m_pendingSignature;
+    m_valid = true;
+    return all;
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_CHECKER_H
+#define UAISO_QTC_CHECKER_H
+
+#include "uaisochunker.h"
+#include "uaisopipeline.h"
+
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace uaiso {
+
+class Factory;
+
+}
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The IncrementalChecker class
+ *
+ * Type checking of a document by top-level declaration. The diagnostics of
+ * each declaration are remembered by a fingerprint of its text, so on the
+ * next revision unchanged declarations keep theirs, wherever they moved,
+ * and only the edited ones are checked: in a source with the preamble and
+ * the declarations of the file they refer to (and those refer to, and so
+ * on) around them. A change to the preamble or to the first line of any
+ * declaration (its signature, mostly) takes a full check.
+ */
+class IncrementalChecker
+{
+public:
+    explicit IncrementalChecker(uaiso::Factory* factory);
+
+    /*!
+     * \brief plan
+     *
+     * Split \a lines and compare them with the last check. Return false if
+     * the whole file needs checking, then recordFull() must follow.
+     */
+    bool plan(const QStringList& lines);
+
+    /*!
+     * \brief checkChanged
+     *
+     * Check the declarations changed since the last check, on maps of its
+     * own, and return the type checking diagnostics of the whole file.
+     * \a decls are the top-level declarations of the file's bound program,
+     * those the changed ones refer to are checked along with them.
+     */
+    QVector<DiagnosticEntry> checkChanged(const QString& fileName,
+                                          const QStringList& lines,
+                                          const QVector<DeclEntry>& decls);
+
+    /*!
+     * \brief recordFull
+     *
+     * Remember the type checking \a diagnostics of a full check.
+     */
+    void recordFull(const QVector<DiagnosticEntry>& diagnostics);
+
+    void reset();
+
+private:
+    QVector<DiagnosticEntry> commit();
+
+    uaiso::Factory* m_factory;
+    SourceChunker m_chunker;
+    bool m_valid;
+    quint64 m_signature;
+    QVector<DiagnosticEntry> m_preamble;
+
+    // Diagnostics with lines relative to the declaration.
+    QHash<quint64, QVector<DiagnosticEntry>> m_byPrint;
+
+    // Of the revision being checked.
+    quint64 m_pendingSignature;
+    QVector<SourceChunk> m_chunks;
+    QVector<quint64> m_prints;
+    QVector<int> m_changed;
+};
+
+} // namespace UaisoQtc
+
+#endif
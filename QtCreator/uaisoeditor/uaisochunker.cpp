@@ -0,0 +1,204 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisochunker.h"
+
+#include <QHash>
+#include <QRegularExpression>
+#include <QSet>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/Factory.h>
+#include <Parsing/IncrementalLexer.h>
+#include <Parsing/Phrasing.h>
+#include <Parsing/Token.h>
+
+#include <algorithm>
+#include <memory>
+
+using namespace UaisoQtc;
+
+namespace {
+
+bool isPreambleWord(const QString& word)
+{
+    // A string statement is a module docstring, and dunders (__all__,
+    // __version__...) are set along with imports.
+    static const QRegularExpression docOrDunder(
+                QLatin1String("^(?:[rRbBuU]{0,2}[\"']|__\\w+__$)"));
+    return word == QLatin1String("package")
+            || word == QLatin1String("module")
+            || word == QLatin1String("import")
+            || word == QLatin1String("from")
+            || docOrDunder.match(word).hasMatch();
+}
+
+} // anonymous
+
+SourceChunker::SourceChunker(uaiso::Factory* factory)
+    : m_factory(factory)
+    , m_preambleEnd(0)
+{}
+
+void SourceChunker::split(const QStringList& lines, int chunkSize)
+{
+    m_chunks.clear();
+    m_preambleEnd = 0;
+
+    std::unique_ptr<uaiso::IncrementalLexer> lexer = m_factory->makeIncrementalLexer();
+    int state = uaiso::IncrementalLexer::State::InCode;
+    int depth = 0;
+    bool inPreamble = true;
+    bool afterDecorator = false;
+    SourceChunk chunk { 0, -1 };
+    int size = 0;
+
+    for (int line = 0; line < lines.size(); ++line) {
+        const QString& text = lines.at(line);
+        const bool atTopLevel = depth == 0 && state == uaiso::IncrementalLexer::State::InCode;
+
+        const std::string utf8 = text.toStdString();
+        lexer->lex(utf8, uaiso::IncrementalLexer::State(state));
+        std::unique_ptr<uaiso::Phrasing> phrasing(lexer->releasePhrasing());
+        state = lexer->state();
+
+        // Columns are in bytes, they only match characters for ASCII.
+        const bool ascii = utf8.size() == static_cast<size_t>(text.size());
+        auto charCol = [&utf8, ascii](int byteCol) {
+            return ascii ? byteCol : charColumn(utf8, byteCol);
+        };
+
+        bool startsDecl = false;
+        QString firstWord;
+        if (phrasing && !phrasing->isEmpty()) {
+            const uaiso::Token first = phrasing->token(0);
+            startsDecl = atTopLevel
+                    && phrasing->lineCol(0).col_ == 0
+                    && !uaiso::isComment(first)
+                    && !afterDecorator;
+            firstWord = text.mid(0, charCol(phrasing->length(0)));
+            afterDecorator = firstWord.startsWith(QLatin1Char('@'));
+
+            for (size_t i = 0; i < phrasing->size(); ++i) {
+                const int col = charCol(phrasing->lineCol(i).col_);
+                if (phrasing->length(i) != 1 || col >= text.size())
+                    continue;
+                const QChar c = text.at(col);
+                if (c == QLatin1Char('{') || c == QLatin1Char('(') || c == QLatin1Char('['))
+                    ++depth;
+                else if ((c == QLatin1Char('}') || c == QLatin1Char(')') || c == QLatin1Char(']'))
+                         && depth > 0)
+                    --depth;
+            }
+        }
+
+        if (inPreamble) {
+            if (!startsDecl || isPreambleWord(firstWord)) {
+                m_preambleEnd = line + 1;
+                continue;
+            }
+            inPreamble = false;
+            chunk.m_firstLine = line;
+        } else if (startsDecl && size >= chunkSize) {
+            chunk.m_lastLine = line - 1;
+            m_chunks.append(chunk);
+            chunk.m_firstLine = line;
+            size = 0;
+        }
+        size += text.size() + 1;
+    }
+
+    if (!inPreamble) {
+        chunk.m_lastLine = lines.size() - 1;
+        m_chunks.append(chunk);
+    }
+}
+
+std::string SourceChunker::compose(const QStringList& lines, int firstLine, int lastLine) const
+{
+    return compose(lines, QVector<SourceChunk>() << SourceChunk { firstLine, lastLine });
+}
+
+std::string SourceChunker::compose(const QStringList& lines,
+                                   const QVector<SourceChunk>& chunks) const
+{
+    std::string code;
+    auto chunk = chunks.begin();
+    for (int line = 0; line < lines.size(); ++line) {
+        while (chunk != chunks.end() && chunk->m_lastLine < line)
+            ++chunk;
+        if (line < m_preambleEnd || (chunk != chunks.end() && line >= chunk->m_firstLine))
+            code += lines.at(line).toStdString();
+        code += '\n';
+    }
+    return code;
+}
+
+QVector<SourceChunk> SourceChunker::withReferenced(const QStringList& lines,
+                                                   const QVector<int>& indexes,
+                                                   const QVector<DeclEntry>& decls) const
+{
+    // A name is a word, as good as the engine's own lexing for the
+    // languages supported.
+    QHash<QString, QVector<int>> chunksByName;
+    for (const DeclEntry& decl : decls) {
+        auto chunk = std::upper_bound(m_chunks.begin(), m_chunks.end(), decl.m_line,
+                                      [](int line, const SourceChunk& chunk) {
+            return line < chunk.m_firstLine;
+        });
+        if (chunk != m_chunks.begin())
+            chunksByName[decl.m_name].append(chunk - m_chunks.begin() - 1);
+    }
+
+    static const QRegularExpression word(QLatin1String("[A-Za-z_]\\w*"));
+    QSet<int> included;
+    QVector<int> pending = indexes;
+    while (!pending.isEmpty()) {
+        const int i = pending.takeLast();
+        if (included.contains(i))
+            continue;
+        included.insert(i);
+
+        const SourceChunk& chunk = m_chunks.at(i);
+        for (int line = chunk.m_firstLine; line <= chunk.m_lastLine; ++line) {
+            QRegularExpressionMatchIterator it = word.globalMatch(lines.at(line));
+            while (it.hasNext()) {
+                for (int other : chunksByName.value(it.next().captured())) {
+                    if (!included.contains(other))
+                        pending.append(other);
+                }
+            }
+        }
+    }
+
+    QList<int> sorted = included.toList();
+    std::sort(sorted.begin(), sorted.end());
+    QVector<SourceChunk> chunks;
+    for (int i : sorted)
+        chunks.append(m_chunks.at(i));
+    return chunks;
+}
@@ -0,0 +1,121 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_CHUNKER_H
+#define UAISO_QTC_CHUNKER_H
+
+#include "uaisopipeline.h"
+
+#include <QStringList>
+#include <QVector>
+
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace uaiso {
+
+class Factory;
+
+}
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The SourceChunk struct
+ *
+ * A run of whole top-level declarations, lines are 0-based and inclusive.
+ */
+struct SourceChunk
+{
+    int m_firstLine;
+    int m_lastLine;
+};
+
+/*!
+ * \brief The SourceChunker class
+ *
+ * Split a source at top-level declaration boundaries, so that pieces of a
+ * huge file can be analysed alone. A boundary is a line starting at column
+ * zero, outside of any bracket, string or comment.
+ *
+ * The preamble (package, module and import lines, and Python's docstring
+ * and dunder assignments such as __all__ among them) is needed by every
+ * piece, it's kept apart and composed back in.
+ */
+class SourceChunker
+{
+public:
+    explicit SourceChunker(uaiso::Factory* factory);
+
+    /*!
+     * \brief split
+     *
+     * Chunks are merged until they have at least \a chunkSize characters.
+     */
+    void split(const QStringList& lines, int chunkSize);
+
+    const QVector<SourceChunk>& chunks() const { return m_chunks; }
+
+    int preambleEnd() const { return m_preambleEnd; }
+
+    /*!
+     * \brief compose
+     *
+     * The source with only the preamble and lines \a firstLine to \a lastLine
+     * in it, every other line is left empty so line numbers stay the same.
+     */
+    std::string compose(const QStringList& lines, int firstLine, int lastLine) const;
+
+    /*!
+     * \brief compose
+     *
+     * The source with only the preamble and the lines of \a chunks (in
+     * order) in it.
+     */
+    std::string compose(const QStringList& lines, const QVector<SourceChunk>& chunks) const;
+
+    /*!
+     * \brief withReferenced
+     *
+     * The chunks at \a indexes along with those declaring a name they
+     * mention, and those their own mention, and so on, in source order.
+     * \a decls are the file's top-level declarations. The engine analyses a
+     * whole AST, this is what a piece needs around it to resolve its names.
+     */
+    QVector<SourceChunk> withReferenced(const QStringList& lines,
+                                        const QVector<int>& indexes,
+                                        const QVector<DeclEntry>& decls) const;
+
+private:
+    uaiso::Factory* m_factory;
+    QVector<SourceChunk> m_chunks;
+    int m_preambleEnd;
+};
+
+} // namespace UaisoQtc
+
+#endif
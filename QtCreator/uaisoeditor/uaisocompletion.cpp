@@ -18,13 +18,26 @@
  *****************************************************************************/
 
 #include "uaisocompletion.h"
-
+#include "uaisofuzzymatcher.h"
+#include "uaisoindex.h"
+#include "uaisopipeline.h"
+#include "uaisoregistry.h"
+#include "uaisoremote.h"
+#include "uaisosettings.h"
+
+#include <coreplugin/editormanager/editormanager.h>
 #include <texteditor/convenience.h>
+#include <texteditor/texteditor.h>
 #include <texteditor/codeassist/assistproposalitem.h>
+#include <texteditor/codeassist/functionhintproposal.h>
 #include <texteditor/codeassist/genericproposal.h>
 #include <texteditor/codeassist/genericproposalmodel.h>
 
+#include <QMutexLocker>
+#include <QSet>
 #include <QTextBlock>
+#include <QWaitCondition>
+#include <QtConcurrentRun>
 
     /* Uaiso - https://github.com/ltcmelo/uaiso
      *
@@ -34,33 +47,384 @@
      * not even complete. The primary concern is to demonstrate Uaiso's API.
      */
 
-#include <Ast/Ast.h>
 #include <Parsing/Factory.h>
 #include <Parsing/IncrementalLexer.h>
 #include <Parsing/Lang.h>
 #include <Parsing/LangId.h>
-#include <Parsing/Lexeme.h>
-#include <Parsing/LexemeMap.h>
 #include <Parsing/Phrasing.h>
-#include <Parsing/TokenMap.h>
-#include <Parsing/Unit.h>
-#include <Semantic/Binder.h>
-#include <Semantic/CompletionProposer.h>
-#include <Semantic/Manager.h>
-#include <Semantic/Program.h>
-#include <Semantic/Snapshot.h>
 #include <Semantic/Symbol.h>
-#include <Semantic/TypeChecker.h>
 
 #include <algorithm>
+#include <climits>
 
 using namespace UaisoQtc;
 using namespace TextEditor;
 
+namespace {
+
+const int kLocalWindow = 32 * 1024; // Characters around the cursor.
+const int kAnswersPerFile = 8;
+const int kMaxPrefetches = 2;
+
+bool isIdentChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+/*!
+ * \brief localProposals
+ *
+ * The words around the cursor, what's in scope is most likely among them.
+ * It's plain text, there's no keyword list: a keyword is only proposed if
+ * it happens to be written nearby. Good enough until the engine answers.
+ */
+QVector<ProposalEntry> localProposals(const AssistInterface* interface, int offset)
+{
+    const QTextDocument* doc = interface->textDocument();
+    const int first = std::max(0, offset - kLocalWindow);
+    const int last = std::min(doc->characterCount() - 1, offset + kLocalWindow);
+
+    QVector<ProposalEntry> proposals;
+    QSet<QString> seen;
+    QString word;
+    for (int i = first; i <= last; ++i) {
+        const QChar c = i < last ? doc->characterAt(i) : QChar();
+        if (isIdentChar(c)) {
+            word.append(c);
+            continue;
+        }
+        // The word being typed isn't a proposal.
+        const bool typed = i - word.size() == offset;
+        if (word.size() > 1 && !word.at(0).isNumber() && !typed && !seen.contains(word)) {
+            seen.insert(word);
+            ProposalEntry entry;
+            entry.m_name = word;
+            entry.m_kind = -1;
+            entry.m_distance = FileScope;
+            proposals.append(entry);
+        }
+        word.clear();
+    }
+    return proposals;
+}
+
+/*!
+ * \brief callSignature
+ *
+ * The signature of the function being called, when right after a call's
+ * delimiter. Signatures were recorded while binding, only indexes are read.
+ */
+QString callSignature(const UaisoAssistInterface* interface)
+{
+    const uaiso::Lang* lang = interface->m_service->lang();
+    const QString& delim = QString::fromStdString(lang->funcCallDelim());
+    const int end = interface->position() - delim.size();
+    if (delim.isEmpty() || end <= 0 || interface->textAt(end, delim.size()) != delim)
+        return QString();
+
+    int start = end;
+    while (start > 0 && isIdentChar(interface->characterAt(start - 1)))
+        --start;
+    if (start == end)
+        return QString();
+    const QString& name = interface->textAt(start, end - start);
+
+    const QTextBlock& block = interface->textDocument()->findBlock(start);
+    UaisoEditorPlugin* plugin = UaisoEditorPlugin::instance();
+    SymbolKey key;
+    QString signature;
+    if (resolveSymbol(interface->m_service, interface->m_loader.get(),
+                      interface->fileName(), interface->m_imports,
+                      block.blockNumber(), start - block.position(), name, &key)
+            && plugin->signatureIndex()->find(key, &signature)) {
+        return signature;
+    }
+
+    // A receiver is rarely resolved while its call is being typed, any
+    // method of that name will do.
+    const QString& access = QString::fromStdString(lang->memberAccessOprtr());
+    if (access.isEmpty() || start < access.size()
+            || interface->textAt(start - access.size(), access.size()) != access) {
+        return QString();
+    }
+    const QStringList& fileNames = QStringList(interface->fileName())
+            + moduleFiles(interface->m_service, interface->m_loader.get(),
+                          interface->fileName(), interface->m_imports);
+    if (plugin->signatureIndex()->findMethod(fileNames, name, &signature))
+        return signature;
+    return QString();
+}
+
+int kindRank(int kind)
+{
+    switch (static_cast<uaiso::Symbol::Kind>(kind)) {
+    case uaiso::Symbol::Kind::Var:
+    case uaiso::Symbol::Kind::Param:
+        return 3;
+    case uaiso::Symbol::Kind::Func:
+        return 2;
+    case uaiso::Symbol::Kind::Record:
+    case uaiso::Symbol::Kind::Enum:
+    case uaiso::Symbol::Kind::EnumItem:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+} // anonymous
+
+    //--- Scheduler ---//
+
+struct CompletionScheduler::Job
+{
+    QMutex m_mutex;
+    QWaitCondition m_done;
+    bool m_finished { false };
+    bool m_abandoned { false };
+    QVector<ProposalEntry> m_proposals;
+};
+
+CompletionScheduler::CompletionScheduler(QObject *parent)
+    : QObject(parent)
+    , m_budget(UaisoSettings().m_completionBudget)
+{
+    // Prefetches trickle in, they never hold up a proposal.
+    m_prefetchPool.setMaxThreadCount(1);
+
+    connect(this, &CompletionScheduler::lateProposals,
+            this, &CompletionScheduler::complete, Qt::QueuedConnection);
+}
+
+CompletionScheduler::~CompletionScheduler()
+{
+    shutdown();
+}
+
+void CompletionScheduler::shutdown()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        for (CancellationToken& token : m_latest)
+            token.cancel();
+        for (CancellationToken& token : m_prefetching)
+            token.cancel();
+    }
+    m_pool.waitForDone();
+    m_prefetchPool.waitForDone();
+}
+
+std::shared_ptr<CompletionScheduler::Job>
+CompletionScheduler::start(const Request& request,
+                           const CancellationToken& token,
+                           QThreadPool* pool)
+{
+    // Prefer the out-of-process analyser, if it's around.
+    auto job = std::make_shared<Job>();
+    m_running.insert(request.m_key, job);
+    QtConcurrent::run(pool, [this, request, token, job]() {
+        // A superseded request doesn't run at all, it's queued behind
+        // analyses which can't be interrupted.
+        const uaiso::LangId langId = request.m_factory->langName();
+        QVector<ProposalEntry> proposals;
+        if (!token.isCanceled()
+                && !UaisoEditorPlugin::instance()->remoteAnalyser()->complete(
+                    langId, request.m_fileName, request.m_searchPaths,
+                    QByteArray::fromStdString(request.m_code),
+                    request.m_line, request.m_col, &proposals)
+                && !token.isCanceled()) {
+            proposals = proposeCompletions(request.m_factory, request.m_searchPaths,
+                                           request.m_code, request.m_fileName,
+                                           request.m_line, request.m_col, token);
+        }
+
+        bool late;
+        {
+            QMutexLocker locker(&job->m_mutex);
+            job->m_finished = true;
+            job->m_proposals = proposals;
+            late = job->m_abandoned;
+            job->m_done.wakeAll();
+        }
+
+        const bool useful = !token.isCanceled() && !proposals.isEmpty();
+        {
+            QMutexLocker locker(&m_mutex);
+            if (m_running.value(request.m_key) == job)
+                m_running.remove(request.m_key);
+            if (useful) {
+                QList<Answer>& answers = m_answers[request.m_fileName];
+                answers.append(Answer { request.m_key, request.m_revision, proposals });
+                if (answers.size() > kAnswersPerFile)
+                    answers.removeFirst();
+            }
+        }
+        if (late && useful)
+            emit lateProposals(request.m_fileName, request.m_offset);
+    });
+    return job;
+}
+
+bool CompletionScheduler::propose(const Request& request, QVector<ProposalEntry>* proposals)
+{
+    std::shared_ptr<Job> job;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const Answer& answer : m_answers.value(request.m_fileName)) {
+            if (answer.m_key == request.m_key) {
+                *proposals = answer.m_proposals;
+                return true;
+            }
+        }
+
+        job = m_running.value(request.m_key);
+        if (!job) {
+            CancellationToken token;
+            auto latest = m_latest.find(request.m_fileName);
+            if (latest != m_latest.end())
+                latest->cancel();
+            m_latest.insert(request.m_fileName, token);
+            job = start(request, token, &m_pool);
+        }
+    }
+
+    QMutexLocker locker(&job->m_mutex);
+    const int budget = m_budget;
+    if (!job->m_finished)
+        job->m_done.wait(&job->m_mutex, budget > 0 ? static_cast<unsigned long>(budget) : ULONG_MAX);
+    if (!job->m_finished) {
+        job->m_abandoned = true;
+        return false;
+    }
+    *proposals = job->m_proposals;
+    return true;
+}
+
+void CompletionScheduler::prefetch(const QString& fileName,
+                                   int revision,
+                                   const QVector<Request>& requests)
+{
+    QMutexLocker locker(&m_mutex);
+    auto previous = m_prefetching.find(fileName);
+    if (previous != m_prefetching.end())
+        previous->cancel();
+    CancellationToken token;
+    m_prefetching.insert(fileName, token);
+
+    // Answers to proposals stay, they may yet be asked for again.
+    QList<Answer>& answers = m_answers[fileName];
+    for (int i = answers.size() - 1; i >= 0; --i) {
+        if (answers.at(i).m_revision >= 0 && answers.at(i).m_revision != revision)
+            answers.removeAt(i);
+    }
+
+    for (const Request& request : requests) {
+        if (m_running.contains(request.m_key))
+            continue;
+        bool known = false;
+        for (const Answer& answer : answers)
+            known = known || answer.m_key == request.m_key;
+        if (known)
+            continue;
+        Request prefetched = request;
+        prefetched.m_revision = revision;
+        start(prefetched, token, &m_prefetchPool);
+    }
+}
+
+quint64 CompletionScheduler::completionKey(const QString& fileName,
+                                           const QString& text,
+                                           int anchor, int offset, int position)
+{
+    return contentHash(fileName, text.left(anchor) + text.mid(position))
+            ^ (static_cast<quint64>(anchor) << 32)
+            ^ qHash(text.mid(anchor, offset - anchor));
+}
+
+QVector<CompletionScheduler::Request>
+CompletionScheduler::speculate(const LangService* service,
+                               const QString& fileName,
+                               const QString& text,
+                               int position,
+                               const QStringList& imports,
+                               const QStringList& searchPaths)
+{
+    QStringList triggers;
+    for (const std::string& seq : { service->lang()->memberAccessOprtr(),
+                                    service->lang()->packageSeparator() }) {
+        if (!seq.empty())
+            triggers.append(QString::fromStdString(seq));
+    }
+    triggers.removeDuplicates();
+    if (triggers.isEmpty())
+        return QVector<Request>();
+
+    // What could be typed at the cursor: a trigger after the word ending
+    // there, or, at a word's start, an imported package and its trigger.
+    int start = position;
+    while (start > 0 && isIdentChar(text.at(start - 1)))
+        --start;
+    QStringList insertions;
+    if (start < position) {
+        if (text.at(start).isNumber())
+            return QVector<Request>();
+        for (const QString& trigger : triggers)
+            insertions.append(trigger);
+    } else {
+        for (const QString& import : imports) {
+            QString name = import;
+            name.remove(QLatin1Char('"'));
+            name = name.mid(name.lastIndexOf(QLatin1Char('/')) + 1);
+            if (name.isEmpty() || name.at(0).isNumber()
+                    || !std::all_of(name.begin(), name.end(), isIdentChar)) {
+                continue;
+            }
+            insertions.append(name + triggers.last());
+        }
+    }
+
+    QVector<Request> requests;
+    for (const QString& insertion : insertions) {
+        if (requests.size() == kMaxPrefetches)
+            break;
+        const QString& code = text.left(position) + insertion + text.mid(position);
+        const int offset = position + insertion.size();
+        Request request;
+        request.m_factory = service->factory().get();
+        request.m_fileName = fileName;
+        request.m_code = code.toStdString();
+        request.m_line = code.left(offset).count(QLatin1Char('\n'));
+        request.m_col = offset - (code.lastIndexOf(QLatin1Char('\n'), offset - 1) + 1);
+        request.m_offset = offset;
+        request.m_key = completionKey(fileName, code, start, offset, offset);
+        request.m_searchPaths = searchPaths;
+        requests.append(request);
+    }
+    return requests;
+}
+
+void CompletionScheduler::complete(const QString &fileName, int offset)
+{
+    auto editor = qobject_cast<BaseTextEditor*>(Core::EditorManager::currentEditor());
+    if (!editor || editor->document()->filePath().toString() != fileName)
+        return;
+
+    // Only while the word the proposals were for is still being typed.
+    TextEditorWidget* widget = editor->editorWidget();
+    const int position = widget->position();
+    if (position < offset)
+        return;
+    for (int i = offset; i < position; ++i) {
+        if (!isIdentChar(widget->document()->characterAt(i)))
+            return;
+    }
+    widget->invokeAssist(Completion);
+}
+
     //--- Provider ---//
 
-UaisoAssistProvider::UaisoAssistProvider(uaiso::Factory *factory)
-    : m_lang(factory->makeLang())
+UaisoAssistProvider::UaisoAssistProvider(const LangService *service)
+    : m_service(service)
 {}
 
 UaisoAssistProvider::~UaisoAssistProvider()
@@ -78,17 +442,12 @@ IAssistProcessor *UaisoAssistProvider::createProcessor() const
 
 int UaisoAssistProvider::activationCharSequenceLength() const
 {
-    return std::max(m_lang->funcCallDelim().size(),
-                    std::max(m_lang->memberAccessOprtr().size(),
-                             m_lang->packageSeparator().size()));
+    return m_service->maxActivationSequenceLength();
 }
 
 bool UaisoAssistProvider::isActivationCharSequence(const QString &sequence) const
 {
-    const std::string& seq = sequence.toStdString();
-    return seq == m_lang->funcCallDelim()
-            || seq == m_lang->memberAccessOprtr()
-            || seq == m_lang->packageSeparator();
+    return m_service->activationSequences().contains(sequence);
 }
 
     //--- Processor ---//
@@ -99,6 +458,13 @@ IAssistProposal* UaisoAssistProcessor::perform(const AssistInterface *assistInte
     if (interface->reason() == IdleEditor && !acceptIdle(interface))
         return nullptr;
 
+    // Right after a call's delimiter, the callee's signature is the hint.
+    const QString& signature = callSignature(interface);
+    if (!signature.isEmpty()) {
+        return new FunctionHintProposal(interface->position(),
+                                        new UaisoFunctionHintModel(signature));
+    }
+
     // Find the "triggering" token (this is, in fact, not generic enough).
     int offset = interface->position();
     QChar chr;
@@ -117,7 +483,7 @@ IAssistProposal* UaisoAssistProcessor::perform(const AssistInterface *assistInte
 
     int actualLine = line;
     int actualCol = col;
-    std::unique_ptr<uaiso::Lang> lang = interface->m_factory->makeLang();
+    const uaiso::Lang* lang = interface->m_service->lang();
     if (!lang->hasNewlineAsTerminator()) {
         bool sameLine = true;
         std::unique_ptr<uaiso::Phrasing> phrasing;
@@ -152,47 +518,52 @@ IAssistProposal* UaisoAssistProcessor::perform(const AssistInterface *assistInte
         }
     }
 
-    uaiso::LexemeMap lexemes;
-    uaiso::TokenMap tokens;
-    uaiso::Snapshot snapshot;
-    uaiso::Manager manager;
-    manager.config(interface->m_factory,
-                   &tokens, &lexemes, snapshot);
-    addSearchPaths(&manager, interface->m_factory->langName());
-    std::unique_ptr<uaiso::Unit> unit = manager.process(
-                interface->textDocument()->toPlainText().toStdString(),
-                interface->fileName().toStdString(),
-                uaiso::LineCol(actualLine, actualCol));
-
-    if (!unit->ast())
-        return nullptr;
-
-    uaiso::TypeChecker checker(interface->m_factory);
-    checker.setLexemes(&lexemes);
-    checker.setTokens(&tokens);
-    checker.check(Program_Cast(unit->ast()));
+    // A member completion is anchored at the expression before its trigger,
+    // the key is then the same as that of a prefetch at the expression.
+    const QString text = interface->textDocument()->toPlainText();
+    int anchor = offset;
+    for (const QString& seq : interface->m_service->activationSequences()) {
+        if (seq == QString::fromStdString(lang->funcCallDelim())
+                || text.midRef(offset - seq.size(), seq.size()) != seq) {
+            continue;
+        }
+        anchor = offset - seq.size();
+        while (anchor > 0 && isIdentChar(text.at(anchor - 1)))
+            --anchor;
+        break;
+    }
 
-    uaiso::CompletionProposer proposer(interface->m_factory);
-    auto result = proposer.propose(Program_Cast(unit->ast()), &lexemes);
-    auto syms = std::get<0>(result);
-    if (syms.empty())
+    CompletionScheduler::Request request;
+    request.m_factory = interface->m_factory;
+    request.m_fileName = interface->fileName();
+    request.m_code = text.toStdString();
+    request.m_line = actualLine;
+    request.m_col = actualCol;
+    request.m_offset = offset;
+    request.m_key = CompletionScheduler::completionKey(interface->fileName(), text, anchor,
+                                                       offset, interface->position());
+    request.m_searchPaths = interface->m_searchPaths;
+
+    // Nearby words meanwhile, the editor asks again once the rest is in.
+    QVector<ProposalEntry> proposals;
+    if (!UaisoEditorPlugin::instance()->completionScheduler()->propose(request, &proposals))
+        proposals = localProposals(interface, offset);
+    if (proposals.isEmpty())
         return nullptr;
 
+    // On equal match, what's declared closer to the completion point wins.
     QList<TextEditor::AssistProposalItem *> items;
-    std::for_each(syms.begin(), syms.end(), [&items] (const uaiso::Symbol* sym) {
-        if (uaiso::isDecl(sym)) {
-            AssistProposalItem *item = new AssistProposalItem;
-            item->setText(QString::fromStdString(ConstDeclSymbol_Cast(sym)->name()->str()));
-            items.append(item);
-        } else if (sym->kind() == uaiso::Symbol::Kind::Namespace) {
-            AssistProposalItem *item = new AssistProposalItem;
-            item->setText(QString::fromStdString(ConstNamespace_Cast(sym)->name()->str()));
-            items.append(item);
-        }
-    });
+    std::unique_ptr<FuzzyMatcher> matcher(new FuzzyMatcher);
+    matcher->reserve(proposals.size());
+    for (const ProposalEntry& proposal : proposals) {
+        AssistProposalItem *item = new AssistProposalItem;
+        item->setText(proposal.m_name);
+        items.append(item);
+        matcher->add(proposal.m_name.toStdString(), kindRank(proposal.m_kind),
+                     proposal.m_distance);
+    }
 
-    GenericProposalModel* model = new GenericProposalModel;
-    model->loadContent(items);
+    GenericProposalModel* model = new UaisoProposalModel(items, std::move(matcher));
 
     return new GenericProposal(offset, model);
 }
@@ -201,7 +572,7 @@ bool UaisoAssistProcessor::acceptIdle(const UaisoAssistInterface* interface) con
 {
     int pos = interface->position();
 
-    std::unique_ptr<uaiso::Lang> thesaurus = interface->m_factory->makeLang();
+    const uaiso::Lang* thesaurus = interface->m_service->lang();
     std::string s(interface->characterAt(pos - 1).toLatin1(), 1);
     if (thesaurus->funcCallDelim() == s
             || thesaurus->memberAccessOprtr() == s
@@ -224,13 +595,123 @@ bool UaisoAssistProcessor::acceptIdle(const UaisoAssistInterface* interface) con
     return true;
 }
 
+    //--- Proposal Model ---//
+
+UaisoProposalModel::UaisoProposalModel(const QList<AssistProposalItem *> &items,
+                                       std::unique_ptr<FuzzyMatcher> matcher)
+    : m_items(items)
+    , m_matcher(std::move(matcher))
+{
+    loadContent(items);
+}
+
+UaisoProposalModel::~UaisoProposalModel()
+{}
+
+void UaisoProposalModel::filter(const QString &prefix)
+{
+    // Items are owned by the base model, we only pick and order them. Every
+    // match is kept, the popup scrolls.
+    m_currentItems.clear();
+    for (size_t index : m_matcher->rank(prefix.toStdString(), m_matcher->size()))
+        m_currentItems.append(m_items.at(static_cast<int>(index)));
+}
+
+bool UaisoProposalModel::isSortable(const QString &) const
+{
+    // Ranking already happened in filter().
+    return false;
+}
+
+    //--- Function Hint Model ---//
+
+UaisoFunctionHintModel::UaisoFunctionHintModel(const QString &signature)
+    : m_currentArg(0)
+{
+    const int open = signature.indexOf(QLatin1Char('('));
+    int close = open;
+    int depth = 0;
+    QString param;
+    for (int i = open + 1; i < signature.size(); ++i) {
+        const QChar c = signature.at(i);
+        if (c == QLatin1Char('(') || c == QLatin1Char('[') || c == QLatin1Char('{')) {
+            ++depth;
+        } else if (c == QLatin1Char(')') || c == QLatin1Char(']') || c == QLatin1Char('}')) {
+            if (depth-- == 0) {
+                close = i;
+                break;
+            }
+        } else if (c == QLatin1Char(',') && depth == 0) {
+            m_params.append(param.trimmed());
+            param.clear();
+            continue;
+        }
+        param.append(c);
+    }
+    if (!param.trimmed().isEmpty())
+        m_params.append(param.trimmed());
+
+    // A method's receiver isn't passed between the parentheses.
+    if (!m_params.isEmpty()
+            && (m_params.first() == QLatin1String("self")
+                || m_params.first() == QLatin1String("cls"))) {
+        m_params.removeFirst();
+    }
+
+    m_head = signature.left(open + 1);
+    m_tail = close > open ? signature.mid(close) : QString(QLatin1Char(')'));
+}
+
+QString UaisoFunctionHintModel::text(int) const
+{
+    QStringList params;
+    for (int i = 0; i < m_params.size(); ++i) {
+        const QString& param = m_params.at(i).toHtmlEscaped();
+        params.append(i == m_currentArg ? QLatin1String("<b>") + param + QLatin1String("</b>")
+                                        : param);
+    }
+    return m_head.toHtmlEscaped() + params.join(QLatin1String(", ")) + m_tail.toHtmlEscaped();
+}
+
+int UaisoFunctionHintModel::activeArgument(const QString &prefix) const
+{
+    // Commas outside nested brackets and strings separate arguments, the
+    // call is over once its parenthesis closes.
+    int arg = 0;
+    int depth = 0;
+    QChar quote;
+    for (int i = 0; i < prefix.size(); ++i) {
+        const QChar c = prefix.at(i);
+        if (!quote.isNull()) {
+            if (c == QLatin1Char('\\'))
+                ++i;
+            else if (c == quote)
+                quote = QChar();
+            continue;
+        }
+        if (c == QLatin1Char('"') || c == QLatin1Char('\'') || c == QLatin1Char('`')) {
+            quote = c;
+        } else if (c == QLatin1Char('(') || c == QLatin1Char('[') || c == QLatin1Char('{')) {
+            ++depth;
+        } else if (c == QLatin1Char(')') || c == QLatin1Char(']') || c == QLatin1Char('}')) {
+            if (depth-- == 0)
+                return -1;
+        } else if (c == QLatin1Char(',') && depth == 0) {
+            ++arg;
+        }
+    }
+    m_currentArg = arg;
+    return arg;
+}
+
     //--- Assist Interface ---//
 
 UaisoAssistInterface::UaisoAssistInterface(QTextDocument *textDocument,
                                            int position,
                                            const QString &fileName,
                                            AssistReason reason,
-                                           uaiso::Factory *factory)
+                                           const LangService *service)
     : AssistInterface(textDocument, position, fileName, reason)
-    , m_factory(factory)
+    , m_service(service)
+    , m_factory(service->factory().get())
 {}
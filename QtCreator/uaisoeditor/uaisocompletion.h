@@ -25,9 +25,141 @@
 #include <texteditor/codeassist/completionassistprovider.h>
 #include <texteditor/codeassist/iassistprocessor.h>
 #include <texteditor/codeassist/assistinterface.h>
+#include <texteditor/codeassist/genericproposalmodel.h>
+#include <texteditor/codeassist/ifunctionhintproposalmodel.h>
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+
+#include <atomic>
+#include <memory>
+
+namespace UaisoQtc {
+class FuzzyMatcher;
+class LangService;
+class ModuleLoader;
+
+/*!
+ * \brief The CompletionScheduler class
+ *
+ * Runs semantic completion on a latency budget. Whatever doesn't make it in
+ * time is kept, keyed by the request, and the editor is asked to complete
+ * again once it arrives, which then finds it. A request supersedes the one
+ * before it for the same file.
+ *
+ * While the user is idle, completions the next keystrokes are likely to
+ * ask for (members of what's at the cursor, imported packages) are
+ * prefetched, one at a time, into the same few entries per file. Every
+ * prefetch is a full analysis of its own, so only a couple are made per
+ * pause and those a newer pause supersedes are dropped without running.
+ *
+ * Answers are keyed by text, not by the receiver's type: the same receiver
+ * completed somewhere else, or after an edit anywhere in the file, misses.
+ */
+class CompletionScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    struct Request
+    {
+        uaiso::Factory* m_factory;
+        QString m_fileName;
+        std::string m_code;
+        int m_line;
+        int m_col;
+        int m_offset;
+        int m_revision { -1 }; // Of the document, set for prefetches.
+        quint64 m_key;
+        QStringList m_searchPaths; // Taken in the GUI thread.
+    };
+
+    CompletionScheduler(QObject *parent = 0);
+    ~CompletionScheduler();
+
+    // In milliseconds, zero waits for the full answer.
+    void setBudget(int budget) { m_budget = budget; }
+    int budget() const { return m_budget; }
+
+    /*!
+     * \brief propose
+     *
+     * Blocking for at most the budget, meant for the completion thread.
+     * Return false if the answer is late. A prefetch of the same request
+     * under way is waited for instead of starting another.
+     */
+    bool propose(const Request& request, QVector<ProposalEntry>* proposals);
+
+    /*!
+     * \brief prefetch
+     *
+     * Replace the file's previous prefetches, their answers included,
+     * with \a requests. GUI thread only.
+     */
+    void prefetch(const QString& fileName, int revision, const QVector<Request>& requests);
+
+    /*!
+     * \brief shutdown
+     *
+     * Cancel what's running and wait for it, nothing is late after this.
+     */
+    void shutdown();
+
+    /*!
+     * \brief completionKey
+     *
+     * Key of a completion at \a offset in \a text, where [anchor, offset)
+     * is an expression and its trigger (or nothing) and [offset, position)
+     * a prefix being typed. Neither is hashed as part of the text, so a
+     * request prefetched before they were typed has the same key.
+     */
+    static quint64 completionKey(const QString& fileName, const QString& text,
+                                 int anchor, int offset, int position);
+
+    /*!
+     * \brief speculate
+     *
+     * Requests for what's likely to be completed next at \a position.
+     */
+    static QVector<Request> speculate(const LangService* service,
+                                      const QString& fileName,
+                                      const QString& text,
+                                      int position,
+                                      const QStringList& imports,
+                                      const QStringList& searchPaths);
+
+signals:
+    void lateProposals(const QString& fileName, int offset);
+
+private slots:
+    void complete(const QString& fileName, int offset);
+
+private:
+    struct Job;
+    struct Answer
+    {
+        quint64 m_key;
+        int m_revision;
+        QVector<ProposalEntry> m_proposals;
+    };
+
+    std::shared_ptr<Job> start(const Request& request,
+                               const CancellationToken& token,
+                               QThreadPool* pool);
+
+    std::atomic<int> m_budget;
+    QMutex m_mutex;
+    QHash<QString, CancellationToken> m_latest;
+    QHash<QString, CancellationToken> m_prefetching;
+    QHash<quint64, std::shared_ptr<Job>> m_running;
+    QHash<QString, QList<Answer>> m_answers;
+    QThreadPool m_pool;
+    QThreadPool m_prefetchPool;
+};
 
-namespace uaiso {
-class Lang;
 }
 
 class UaisoAssistProvider : public TextEditor::CompletionAssistProvider
@@ -35,7 +167,7 @@ class UaisoAssistProvider : public TextEditor::CompletionAssistProvider
     Q_OBJECT
 
 public:
-    UaisoAssistProvider(uaiso::Factory* factory);
+    UaisoAssistProvider(const UaisoQtc::LangService* service);
     ~UaisoAssistProvider();
 
     bool supportsEditor(Core::Id editorId) const Q_DECL_OVERRIDE;
@@ -43,7 +175,7 @@ public:
     int activationCharSequenceLength() const Q_DECL_OVERRIDE;
     bool isActivationCharSequence(const QString &sequence) const Q_DECL_OVERRIDE;
 
-    std::unique_ptr<uaiso::Lang> m_lang;
+    const UaisoQtc::LangService* m_service;
 };
 
 class UaisoAssistInterface;
@@ -57,6 +189,38 @@ public:
     bool acceptIdle(const UaisoAssistInterface* interface) const;
 };
 
+class UaisoProposalModel : public TextEditor::GenericProposalModel
+{
+public:
+    UaisoProposalModel(const QList<TextEditor::AssistProposalItem *> &items,
+                       std::unique_ptr<UaisoQtc::FuzzyMatcher> matcher);
+    ~UaisoProposalModel();
+
+    void filter(const QString &prefix) Q_DECL_OVERRIDE;
+    bool isSortable(const QString &prefix) const Q_DECL_OVERRIDE;
+
+private:
+    QList<TextEditor::AssistProposalItem *> m_items;
+    std::unique_ptr<UaisoQtc::FuzzyMatcher> m_matcher;
+};
+
+class UaisoFunctionHintModel : public TextEditor::IFunctionHintProposalModel
+{
+public:
+    explicit UaisoFunctionHintModel(const QString& signature);
+
+    void reset() Q_DECL_OVERRIDE {}
+    int size() const Q_DECL_OVERRIDE { return 1; }
+    QString text(int index) const Q_DECL_OVERRIDE;
+    int activeArgument(const QString &prefix) const Q_DECL_OVERRIDE;
+
+private:
+    QString m_head;
+    QStringList m_params;
+    QString m_tail;
+    mutable int m_currentArg;
+};
+
 class UaisoAssistInterface : public TextEditor::AssistInterface
 {
 public:
@@ -64,9 +228,17 @@ public:
                          int position,
                          const QString &fileName,
                          TextEditor::AssistReason reason,
-                         uaiso::Factory* factory);
+                         const UaisoQtc::LangService* service);
 
+    const UaisoQtc::LangService* m_service;
     uaiso::Factory* m_factory;
+
+    // Settings can only be read in the GUI thread, processing isn't there.
+    QStringList m_searchPaths;
+
+    // What the callee of a call is resolved against, for signature hints.
+    std::shared_ptr<UaisoQtc::ModuleLoader> m_loader;
+    QStringList m_imports;
 };
 
 #endif
@@ -0,0 +1,184 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisodependencies.h"
+#include "uaisoloader.h"
+#include "uaisopipeline.h"
+
+#include <QFileInfo>
+#include <QFutureWatcher>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/Factory.h>
+#include <Semantic/Manager.h>
+
+using namespace UaisoQtc;
+
+namespace {
+
+// Whether import \a import may refer to the module in \a fileName. Imports
+// are written with dots (Python, D) or slashes (Go), we compare them as a
+// path suffix of the file without its extension.
+bool mayResolveTo(const QString& import, const QString& fileName)
+{
+    QFileInfo info(fileName);
+    QString module = info.path() + QLatin1Char('/') + info.completeBaseName();
+    QString path = import;
+    path.replace(QLatin1Char('.'), QLatin1Char('/'));
+    return module.endsWith(QLatin1Char('/') + path)
+            || info.path().endsWith(QLatin1Char('/') + path); // Go packages
+}
+
+} // anonymous
+
+DependencyManager::DependencyManager(uaiso::Factory* factory,
+                                     uaiso::TokenMap* tokens,
+                                     uaiso::LexemeMap* lexemes,
+                                     uaiso::Snapshot snapshot,
+                                     ModuleStore* store,
+                                     const QStringList& searchPaths)
+    : m_manager(new uaiso::Manager)
+    , m_loader(new ModuleLoader(factory, snapshot, store, searchPaths))
+    , m_searchPaths(searchPaths)
+    , m_async(false)
+    , m_alive(std::make_shared<bool>(true))
+{
+    m_manager->config(factory, tokens, lexemes, snapshot);
+    addSearchPaths(m_manager.get(), m_searchPaths);
+}
+
+DependencyManager::~DependencyManager()
+{}
+
+bool DependencyManager::processDeps(const QString& fileName,
+                                    const QStringList& imports,
+                                    const Loaded& loaded)
+{
+    const QSet<QString> current = imports.toSet();
+    QSet<QString>& known = m_importsByFile[fileName];
+
+    // Staleness is per importer, every one of them gets to process it.
+    const QSet<QString> stale = m_staleByFile.take(fileName);
+    bool pending = false;
+    for (const QString& import : current) {
+        if (pending)
+            break;
+        pending = !known.contains(import) || stale.contains(import);
+    }
+
+    // Removed imports only need to leave the graph.
+    for (const QString& import : known - current) {
+        auto it = m_filesByImport.find(import);
+        if (it == m_filesByImport.end())
+            continue;
+        it->remove(fileName);
+        if (it->isEmpty())
+            m_filesByImport.erase(it);
+    }
+    for (const QString& import : current)
+        m_filesByImport[import].insert(fileName);
+    known = current;
+
+    if (!pending)
+        return false;
+
+    if (!m_async) {
+        QStringList failed;
+        const QStringList& unresolved = m_loader->load(fileName, current.toList(), &failed);
+        finishLoad(fileName, unresolved, failed);
+        if (loaded)
+            loaded();
+        return true;
+    }
+
+    // The manager may be gone by the time the fetch is done.
+    std::weak_ptr<bool> alive = m_alive;
+    auto watcher = new QFutureWatcher<ModuleLoader::Fetched>;
+    QObject::connect(watcher, &QFutureWatcherBase::finished, watcher,
+                     [this, alive, watcher, fileName, loaded]() {
+        watcher->deleteLater();
+        if (alive.expired())
+            return;
+        const ModuleLoader::Fetched& fetched = watcher->result();
+        m_loader->publish(fetched.m_modules);
+        finishLoad(fileName, fetched.m_unresolved, fetched.m_failed);
+        if (loaded && !fetched.m_modules.isEmpty())
+            loaded();
+    });
+    watcher->setFuture(m_loader->fetchAsync(fileName, current.toList()));
+    return true;
+}
+
+void DependencyManager::finishLoad(const QString& fileName,
+                                   const QStringList& unresolved,
+                                   const QStringList& failed)
+{
+    // The Manager binds into the snapshot, which the GUI thread owns.
+    m_unresolved += unresolved.toSet();
+    if (!unresolved.isEmpty() && !m_async)
+        m_manager->processDeps(fileName.toStdString());
+
+    // Neither counts as processed, but retrying is pointless until a search
+    // path or a module changes.
+    const QSet<QString> retry = unresolved.toSet() + failed.toSet();
+    if (retry.isEmpty())
+        m_retryByFile.remove(fileName);
+    else
+        m_retryByFile.insert(fileName, retry);
+}
+
+void DependencyManager::invalidate(const QString& fileName)
+{
+    for (auto it = m_filesByImport.constBegin(); it != m_filesByImport.constEnd(); ++it) {
+        if (!mayResolveTo(it.key(), fileName))
+            continue;
+        for (const QString& importer : it.value())
+            m_staleByFile[importer].insert(it.key());
+    }
+}
+
+void DependencyManager::retryFailed()
+{
+    for (auto it = m_retryByFile.constBegin(); it != m_retryByFile.constEnd(); ++it)
+        m_staleByFile[it.key()] += it.value();
+    m_retryByFile.clear();
+    m_unresolved.clear();
+}
+
+void DependencyManager::remove(const QString& fileName)
+{
+    m_staleByFile.remove(fileName);
+    m_retryByFile.remove(fileName);
+    for (const QString& import : m_importsByFile.take(fileName)) {
+        auto it = m_filesByImport.find(import);
+        if (it == m_filesByImport.end())
+            continue;
+        it->remove(fileName);
+        if (it->isEmpty())
+            m_filesByImport.erase(it);
+    }
+}
@@ -0,0 +1,155 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_DEPENDENCIES_H
+#define UAISO_QTC_DEPENDENCIES_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+#include <memory>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/LexemeMap.h>
+#include <Parsing/TokenMap.h>
+#include <Semantic/Snapshot.h>
+
+namespace uaiso {
+
+class Factory;
+class Manager;
+
+}
+
+namespace UaisoQtc {
+
+class ModuleLoader;
+class ModuleStore;
+
+/*!
+ * \brief The DependencyManager class
+ *
+ * A long-lived Manager (one per language) together with the import graph
+ * of every file it has seen. Imports are only handed to the Manager when
+ * they show up for the first time in a file or when the module they refer
+ * to was invalidated, otherwise the previous resolution still holds.
+ *
+ * Imports are loaded by a ModuleLoader, in parallel. Those the loader can't
+ * resolve, and the ones which failed to load, are only tried again after
+ * retryFailed, once something they could resolve to has changed.
+ *
+ * Loading blocks, unless the manager is asynchronous (as it must be in the
+ * GUI thread), in which case it runs in a worker and the result is
+ * published once it's back in the manager's thread. The Manager binds
+ * against the shared snapshot, so only a synchronous manager (off the GUI
+ * thread) hands it what the loader couldn't resolve.
+ */
+class DependencyManager
+{
+public:
+    DependencyManager(uaiso::Factory* factory,
+                      uaiso::TokenMap* tokens,
+                      uaiso::LexemeMap* lexemes,
+                      uaiso::Snapshot snapshot,
+                      ModuleStore* store,
+                      const QStringList& searchPaths);
+    ~DependencyManager();
+
+    typedef std::function<void ()> Loaded;
+
+    void setAsynchronous(bool async) { m_async = async; }
+
+    /*!
+     * \brief processDeps
+     *
+     * Update the graph with the \a imports of \a fileName and load them
+     * if any needs processing. Return whether it did.
+     * \a loaded is called once new modules are in the snapshot.
+     */
+    bool processDeps(const QString& fileName,
+                     const QStringList& imports,
+                     const Loaded& loaded = Loaded());
+
+    /*!
+     * \brief invalidate
+     *
+     * \a fileName has changed, imports that may resolve to it are going to
+     * be processed again by each of their importers.
+     */
+    void invalidate(const QString& fileName);
+
+    /*!
+     * \brief retryFailed
+     *
+     * Search paths or the modules behind them have changed, imports which
+     * didn't resolve or load are processed again by their importers.
+     */
+    void retryFailed();
+
+    /*!
+     * \brief remove
+     *
+     * \a fileName is no longer processed (closed, deleted or renamed), its
+     * imports leave the graph.
+     */
+    void remove(const QString& fileName);
+
+    /*!
+     * \brief unresolvedImports
+     *
+     * Imports the loader couldn't resolve. A synchronous manager leaves
+     * them to the Manager, which doesn't tell where it finds them.
+     */
+    QStringList unresolvedImports() const { return m_unresolved.toList(); }
+
+    const QStringList& searchPaths() const { return m_searchPaths; }
+
+    std::shared_ptr<ModuleLoader> loader() const { return m_loader; }
+
+private:
+    void finishLoad(const QString& fileName,
+                    const QStringList& unresolved,
+                    const QStringList& failed);
+
+    std::unique_ptr<uaiso::Manager> m_manager;
+    std::shared_ptr<ModuleLoader> m_loader;
+    QStringList m_searchPaths;
+    QHash<QString, QSet<QString>> m_importsByFile;
+    QHash<QString, QSet<QString>> m_filesByImport;
+    QHash<QString, QSet<QString>> m_staleByFile;
+    QHash<QString, QSet<QString>> m_retryByFile;
+    QSet<QString> m_unresolved;
+    bool m_async;
+    std::shared_ptr<bool> m_alive; // Watched by loads in flight.
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -18,15 +18,36 @@
  *****************************************************************************/
 
 #include "uaisoeditor.h"
+#include "uaisochecker.h"
+#include "uaisochunker.h"
 #include "uaisocompletion.h"
+#include "uaisodependencies.h"
+#include "uaisogo.h"
+#include "uaisoindex.h"
+#include "uaisoloader.h"
+#include "uaisolocator.h"
+#include "uaisomemory.h"
+#include "uaisoregistry.h"
+#include "uaisopython.h"
+#include "uaisoremote.h"
+#include "uaisosession.h"
 #include "uaisosettings.h"
 
 #include <coreplugin/actionmanager/actioncontainer.h>
 #include <coreplugin/actionmanager/actionmanager.h>
 #include <coreplugin/coreconstants.h>
+#include <coreplugin/documentmanager.h>
+#include <coreplugin/editormanager/documentmodel.h>
+#include <coreplugin/editormanager/editormanager.h>
+#include <coreplugin/editormanager/ieditor.h>
+#include <coreplugin/find/searchresultwindow.h>
+#include <coreplugin/icontext.h>
 #include <coreplugin/icore.h>
+#include <coreplugin/idocument.h>
+#include <coreplugin/infobar.h>
 #include <coreplugin/navigationwidget.h>
 #include <coreplugin/progressmanager/progressmanager.h>
+#include <projectexplorer/session.h>
 #include <texteditor/fontsettings.h>
 #include <texteditor/texteditoractionhandler.h>
 #include <texteditor/texteditorconstants.h>
@@ -37,12 +58,18 @@
 #include <utils/fileutils.h>
 
 #include <QCoreApplication>
+#include <QFile>
 #include <QFileInfo>
 #include <QFuture>
 #include <QFutureInterface>
+#include <QFutureWatcher>
+#include <QMenu>
+#include <QPointer>
+#include <QScrollBar>
 #include <QProcessEnvironment>
 #include <QStringList>
 #include <QTextBlock>
+#include <QtConcurrentMap>
 #include <QtConcurrentRun>
 
     /* Uaiso - https://github.com/ltcmelo/uaiso
@@ -71,6 +98,7 @@
 #include <Semantic/SymbolCollector.h>
 #include <Semantic/TypeChecker.h>
 #include <algorithm>
+#include <functional>
 
 
 using namespace UaisoQtc;
@@ -82,6 +110,70 @@ namespace {
 
 const int kSyntaxCheckInterval = 200;
 const int kSemanticCheckInterval = 100;
+const int kPrefetchDelay = 500;
+const int kWarmUpDelay = 2000;
+const int kChunkSize = 32 * 1024;
+const int kViewportMargin = 200; // Lines around the viewport.
+const int kResultCacheCost = 16 * 1024 * 1024; // Bytes.
+const int kIndexRefreshDelay = 5000;
+const int kPreviewLines = 5000;
+const int kPreviewChunkSize = 16 * 1024;
+
+QString sessionCachePath()
+{
+    return Core::ICore::userResourcePath() + QLatin1String("/uaiso/")
+            + ProjectExplorer::SessionManager::activeSession() + QLatin1String(".cache");
+}
+
+// What dependants can see of a program: its imports, and its declarations
+// by name, kind and header (a function's parameters, what a record's body
+// declares one level in). Bodies and positions don't count, editing inside
+// a function leaves the published program alone.
+quint64 bindingSignature(const QVector<DeclEntry>& decls,
+                         const QStringList& imports,
+                         const QStringList& lines)
+{
+    QVector<int> starts;
+    for (const DeclEntry& decl : decls)
+        starts.append(decl.m_line);
+    std::sort(starts.begin(), starts.end());
+
+    QString signature = imports.join(QLatin1Char('\n'));
+    for (const DeclEntry& decl : decls) {
+        signature += QLatin1Char('\n') + decl.m_name + QLatin1Char(' ')
+                + QString::number(decl.m_kind);
+        if (decl.m_line < 0 || decl.m_line >= lines.size())
+            continue;
+
+        const QString& text = lines.at(decl.m_line);
+        const int col = charColumn(text.toStdString(), decl.m_col);
+        const QString& header = declarationHeader(lines, decl.m_line, col);
+        signature += QLatin1Char('\n') + (header.isEmpty() ? text.trimmed() : header);
+        if (static_cast<uaiso::Symbol::Kind>(decl.m_kind) != uaiso::Symbol::Kind::Record)
+            continue;
+
+        // A record extends up to the next declaration.
+        auto next = std::upper_bound(starts.begin(), starts.end(), decl.m_line);
+        const int end = next == starts.end() ? lines.size() : *next;
+        for (const MemberEntry& member : recordMembers(lines, decl.m_line, end))
+            signature += QLatin1Char('\n') + member.m_header;
+    }
+    return contentHash(QString(), signature);
+}
+
+int approximateCost(const AnalysisResult& result)
+{
+    int cost = result.m_refs.size() * sizeof(SymbolRef)
+            + result.m_decls.size() * sizeof(DeclEntry)
+            + result.m_diagnostics.size() * sizeof(DiagnosticEntry);
+    for (const DeclEntry& decl : result.m_decls)
+        cost += decl.m_name.size() * sizeof(QChar);
+    for (const DiagnosticEntry& diagnostic : result.m_diagnostics)
+        cost += diagnostic.m_desc.size() * sizeof(QChar);
+    for (const QString& import : result.m_imports)
+        cost += import.size() * sizeof(QChar);
+    return cost;
+}
 
 } // anonymous
 
@@ -92,9 +184,34 @@ const int kSemanticCheckInterval = 100;
 UaisoEditorPlugin *UaisoEditorPlugin::m_instance = 0;
 
 UaisoEditorPlugin::UaisoEditorPlugin()
-    : m_settingsPage(new UaisoSettingsPage)
+    : m_symbolIndex(new SymbolIndex)
+    , m_usageIndex(new UsageIndex)
+    , m_declIndex(new DeclIndex)
+    , m_signatureIndex(new SignatureIndex)
+    , m_registry(new LangRegistry)
+    , m_moduleStore(new ModuleStore)
+    , m_sessionCache(new SessionCache)
+    , m_sessionRestored(false)
+    , m_stubIndex(new PythonStubIndex(m_registry.get()))
+    , m_goIndex(new GoPackageIndex)
+    , m_settingsPage(new UaisoSettingsPage)
+    , m_memoryPane(new UaisoMemoryPane)
+    , m_remoteAnalyser(new UaisoRemoteAnalyser(this))
+    , m_completionScheduler(new CompletionScheduler(this))
+    , m_largeFileThreshold(UaisoSettings().m_largeFileThreshold)
 {
     m_instance = this;
+    m_resultCache.setMaxCost(kResultCacheCost);
+
+    // Installing or removing a package touches site-packages itself.
+    m_stubTimer.setSingleShot(true);
+    m_stubTimer.setInterval(kIndexRefreshDelay);
+    connect(&m_stubTimer, SIGNAL(timeout()), this, SLOT(refreshStubs()));
+    connect(&m_siteWatcher, SIGNAL(directoryChanged(QString)), &m_stubTimer, SLOT(start()));
+
+    m_goIndexTimer.setSingleShot(true);
+    m_goIndexTimer.setInterval(kIndexRefreshDelay);
+    connect(&m_goIndexTimer, SIGNAL(timeout()), this, SLOT(buildGoIndex()));
 }
 
 UaisoEditorPlugin::~UaisoEditorPlugin()
@@ -114,18 +231,380 @@ bool UaisoEditorPlugin::initialize(const QStringList & /*arguments*/,
 
     addAutoReleasedObject(new UaisoEditorFactory);
     addAutoReleasedObject(m_settingsPage);
+    addAutoReleasedObject(m_memoryPane);
+    addAutoReleasedObject(new UaisoSymbolFilter(m_symbolIndex.get()));
+
+    Core::ActionContainer *menu = Core::ActionManager::createMenu(Constants::MENU_ID);
+    menu->menu()->setTitle(tr("Uaiso"));
+    Core::ActionManager::actionContainer(Core::Constants::M_TOOLS)->addMenu(menu);
+
+    QAction *dumpMemory = new QAction(tr("Dump Memory Usage"), this);
+    Core::Command *cmd = Core::ActionManager::registerAction(
+                dumpMemory, Constants::DUMP_MEMORY_ACTION_ID,
+                Core::Context(Core::Constants::C_GLOBAL));
+    menu->addAction(cmd);
+    connect(dumpMemory, &QAction::triggered, m_memoryPane, &UaisoMemoryPane::dump);
 
     return true;
 }
 
 void UaisoEditorPlugin::extensionsInitialized()
-{}
+{
+    UaisoSettings settings;
+    settings.load(Core::ICore::settings());
+    m_remoteAnalyser->setEnabled(settings.m_outOfProcess);
+    m_largeFileThreshold = settings.m_largeFileThreshold;
+    m_completionScheduler->setBudget(settings.m_completionBudget);
+
+    // Let startup finish first.
+    QTimer::singleShot(kWarmUpDelay, this, SLOT(warmUp()));
+
+    ProjectExplorer::SessionManager *sessions = ProjectExplorer::SessionManager::instance();
+    connect(sessions, SIGNAL(aboutToUnloadSession(QString)), this, SLOT(saveSession()));
+    connect(sessions, SIGNAL(aboutToLoadSession(QString)), this, SLOT(resetSession()));
+
+    // Indexes outlive documents, but not their files.
+    connect(Core::EditorManager::instance(), SIGNAL(editorsClosed(QList<Core::IEditor*>)),
+            this, SLOT(editorsClosed(QList<Core::IEditor*>)));
+    connect(Core::DocumentManager::instance(), SIGNAL(allDocumentsRenamed(QString,QString)),
+            this, SLOT(documentRenamed(QString,QString)));
+}
+
+ExtensionSystem::IPlugin::ShutdownFlag UaisoEditorPlugin::aboutToShutdown()
+{
+    saveSession();
+    m_completionScheduler->shutdown();
+    m_indexCancellation.cancel();
+    m_stubRefresh.waitForFinished();
+    m_goIndexBuild.waitForFinished();
+    return SynchronousShutdown;
+}
+
+void UaisoEditorPlugin::warmUp()
+{
+    UaisoSettings settings;
+    settings.load(Core::ICore::settings());
+    for (auto lang : uaiso::availableLangs()) {
+        const UaisoSettings::LangOptions& options = settings.m_options[static_cast<int>(lang)];
+        if (!options.m_enabled)
+            continue;
+
+        // Python's search paths come from its interpreter, which goes first.
+        if (lang == uaiso::LangId::Py && !options.m_interpreter.isEmpty()) {
+            updatePythonEnvironment();
+            continue;
+        }
+
+        // Imports resolve meanwhile, the index only spares lookups on disk.
+        if (lang == uaiso::LangId::Go)
+            buildGoIndex();
+        warmUpLang(lang);
+    }
+}
+
+void UaisoEditorPlugin::warmUpLang(uaiso::LangId lang)
+{
+    // Build the language's services and bring in its prelude, parsing
+    // and binding happen off the GUI thread.
+    const LangService* service = m_registry->service(lang);
+    std::shared_ptr<ModuleLoader> loader = dependencyManager(lang)->loader();
+    const QStringList prelude = service->preludeModules();
+    auto watcher = new QFutureWatcher<ModuleLoader::Modules>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [loader, watcher]() {
+        loader->publish(watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([loader, prelude]() {
+        return loader->fetch(QString(), prelude,
+                             [](const QString&) { return false; });
+    }));
+}
+
+QStringList UaisoEditorPlugin::interpreterPaths() const
+{
+    QMutexLocker locker(&m_pythonLock);
+    return m_interpreterPaths;
+}
+
+void UaisoEditorPlugin::updatePythonEnvironment()
+{
+    UaisoSettings settings;
+    settings.load(Core::ICore::settings());
+    const UaisoSettings::LangOptions& options =
+            settings.m_options[static_cast<int>(uaiso::LangId::Py)];
+    const QString interpreter = options.m_enabled ? options.m_interpreter : QString();
+    {
+        QMutexLocker locker(&m_pythonLock);
+        if (interpreter == m_interpreter)
+            return;
+        m_interpreter = interpreter;
+        m_interpreterPaths.clear();
+    }
+    if (interpreter.isEmpty())
+        return;
+
+    auto watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, interpreter]() {
+        watcher->deleteLater();
+        {
+            QMutexLocker locker(&m_pythonLock);
+            if (interpreter != m_interpreter)
+                return;
+            m_interpreterPaths = watcher->result();
+        }
+
+        // Managers take search paths when created, and what the previous
+        // interpreter's paths loaded must be loaded again.
+        m_deps.erase(static_cast<int>(uaiso::LangId::Py));
+        m_moduleStore->invalidateDependencies(sourceSuffix(uaiso::LangId::Py));
+        m_resultCache.clear();
+        warmUpLang(uaiso::LangId::Py);
+        refreshStubs();
+    });
+    watcher->setFuture(QtConcurrent::run(&interpreterSearchPaths, interpreter));
+}
+
+void UaisoEditorPlugin::refreshStubs()
+{
+    QStringList sites;
+    for (const QString& path : interpreterPaths()) {
+        if (isSitePackages(path))
+            sites.append(path);
+    }
+
+    if (!m_siteWatcher.directories().isEmpty())
+        m_siteWatcher.removePaths(m_siteWatcher.directories());
+    if (sites.isEmpty())
+        return;
+    m_siteWatcher.addPaths(sites);
+
+    // One refresh at a time, a change meanwhile is picked up later.
+    if (m_stubRefresh.isRunning()) {
+        m_stubTimer.start();
+        return;
+    }
+
+    PythonStubIndex* index = m_stubIndex.get();
+    const QString cachePath = Core::ICore::userResourcePath()
+            + QLatin1String("/uaiso/python-stubs.cache");
+    const CancellationToken token = m_indexCancellation;
+    m_stubRefresh = QtConcurrent::run([index, sites, cachePath, token]() {
+        index->refresh(sites, cachePath, token);
+    });
+
+    // Packages may have been installed for imports that didn't resolve.
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        retryFailedImports(uaiso::LangId::Py);
+    });
+    watcher->setFuture(m_stubRefresh);
+}
+
+void UaisoEditorPlugin::updateGoIndex()
+{
+    UaisoSettings settings;
+    settings.load(Core::ICore::settings());
+    if (settings.m_options[static_cast<int>(uaiso::LangId::Go)].m_enabled)
+        buildGoIndex();
+}
+
+void UaisoEditorPlugin::buildGoIndex()
+{
+    // Same as stubs, one build at a time.
+    if (m_goIndexBuild.isRunning()) {
+        m_goIndexTimer.start();
+        return;
+    }
+
+    GoPackageIndex* index = m_goIndex.get();
+    const QStringList searchPaths = searchPathsFor(uaiso::LangId::Go);
+    const CancellationToken token = m_indexCancellation;
+    m_goIndexBuild = QtConcurrent::run([index, searchPaths, token]() {
+        index->build(searchPaths, token);
+    });
+
+    auto watcher = new QFutureWatcher<void>(this);
+    connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher]() {
+        watcher->deleteLater();
+        retryFailedImports(uaiso::LangId::Go);
+    });
+    watcher->setFuture(m_goIndexBuild);
+}
+
+void UaisoEditorPlugin::editorsClosed(const QList<Core::IEditor*>& editors)
+{
+    for (Core::IEditor* editor : editors) {
+        const QString& fileName = editor->document()->filePath().toString();
+        if (Core::DocumentModel::documentForFilePath(fileName))
+            continue; // Still open in another editor.
+
+        // Only documents are processed, imports of a closed one don't need
+        // to be tracked anymore.
+        for (const auto& deps : m_deps)
+            deps.second->remove(fileName);
+
+        // A document is closed when its file is deleted, otherwise what's
+        // indexed for it still holds.
+        if (!QFileInfo::exists(fileName))
+            forgetFile(fileName);
+    }
+}
+
+void UaisoEditorPlugin::documentRenamed(const QString& from, const QString& /*to*/)
+{
+    // The document is indexed again under its new name once analysed.
+    forgetFile(from);
+}
+
+void UaisoEditorPlugin::forgetFile(const QString& fileName)
+{
+    m_symbolIndex->remove(fileName);
+    m_declIndex->remove(fileName);
+    m_signatureIndex->remove(fileName);
+
+    // References from it are gone, Find Usages must not list them.
+    m_usageIndex->remove(fileName);
+
+    // Importers which resolved to it must look again.
+    for (const auto& deps : m_deps) {
+        deps.second->invalidate(fileName);
+        deps.second->remove(fileName);
+    }
+}
+
+void UaisoEditorPlugin::retryFailedImports(uaiso::LangId lang)
+{
+    // A manager created meanwhile has nothing to retry.
+    auto it = m_deps.find(static_cast<int>(lang));
+    if (it != m_deps.end())
+        it->second->retryFailed();
+}
 
 UaisoSettingsPage *UaisoEditorPlugin::settingsPage()
 {
     return m_settingsPage;
 }
 
+UaisoMemoryPane *UaisoEditorPlugin::memoryPane()
+{
+    return m_memoryPane;
+}
+
+UaisoRemoteAnalyser *UaisoEditorPlugin::remoteAnalyser()
+{
+    return m_remoteAnalyser;
+}
+
+CompletionScheduler *UaisoEditorPlugin::completionScheduler()
+{
+    return m_completionScheduler;
+}
+
+DependencyManager *UaisoEditorPlugin::dependencyManager(uaiso::LangId lang)
+{
+    std::unique_ptr<DependencyManager>& deps = m_deps[static_cast<int>(lang)];
+    if (!deps) {
+        deps.reset(new DependencyManager(m_registry->service(lang)->factory().get(),
+                                         &m_tokens, &m_lexemes,
+                                         m_snapshot,
+                                         m_moduleStore.get(),
+                                         searchPathsFor(lang)));
+
+        // Loading must not block the GUI.
+        deps->setAsynchronous(true);
+
+        // Installed modules are loaded from their stubs.
+        if (lang == uaiso::LangId::Py) {
+            PythonStubIndex* stubs = m_stubIndex.get();
+            deps->loader()->setSource([stubs](const QString& fileName, std::string* code) {
+                return stubs->stub(fileName, code);
+            });
+        }
+
+        // Dependencies are found by the locator too, and their declarations
+        // key the references to them.
+        SymbolIndex* symbols = m_symbolIndex.get();
+        DeclIndex* decls = m_declIndex.get();
+        deps->loader()->setObserver([symbols, decls](const QString& fileName,
+                                                     const uaiso::Program* prog) {
+            const QVector<DeclEntry>& entries = declEntries(prog);
+            symbols->update(fileName, entries);
+            decls->update(fileName, entries);
+        });
+
+        // Go imports go through the package index, not search paths.
+        if (lang == uaiso::LangId::Go) {
+            GoPackageIndex* packages = m_goIndex.get();
+            deps->loader()->setResolver([packages](const QString& import, const QString& importer) {
+                return packages->resolve(import, importer);
+            });
+        }
+    }
+    return deps.get();
+}
+
+QStringList UaisoEditorPlugin::snapshotFiles() const
+{
+    return m_moduleStore->files();
+}
+
+QStringList UaisoEditorPlugin::unresolvedImports() const
+{
+    QStringList imports;
+    for (const auto& deps : m_deps)
+        imports += deps.second->unresolvedImports();
+    return imports;
+}
+
+void UaisoEditorPlugin::resetDependencyManagers()
+{
+    m_deps.clear();
+    m_moduleStore->invalidateDependencies();
+
+    // Results depend on where imports were found.
+    m_resultCache.clear();
+}
+
+const AnalysisResult *UaisoEditorPlugin::cachedResult(quint64 key)
+{
+    restoreSession();
+    return m_resultCache.object(key);
+}
+
+void UaisoEditorPlugin::cacheResult(quint64 key, const AnalysisResult &result)
+{
+    m_resultCache.insert(key, new AnalysisResult(result), approximateCost(result));
+}
+
+void UaisoEditorPlugin::restoreSession()
+{
+    if (m_sessionRestored)
+        return;
+    m_sessionRestored = true;
+
+    // Documents of the session about to open will find their results, and
+    // the indexes cover the session's files, opened or not.
+    for (const SessionCache::Entry& entry : m_sessionCache->restore(sessionCachePath())) {
+        cacheResult(entry.m_key, entry.m_result);
+        m_symbolIndex->update(entry.m_fileName, entry.m_result.m_decls);
+        m_declIndex->update(entry.m_fileName, entry.m_result.m_decls);
+        m_usageIndex->update(entry.m_fileName, entry.m_result.m_refs);
+    }
+}
+
+void UaisoEditorPlugin::saveSession()
+{
+    if (m_sessionRestored)
+        m_sessionCache->save(sessionCachePath());
+}
+
+void UaisoEditorPlugin::resetSession()
+{
+    m_sessionCache->clear();
+    m_sessionRestored = false;
+}
+
     //---------------//
     //--- Factory ---//
     //---------------//
@@ -147,7 +626,9 @@ UaisoEditorFactory::UaisoEditorFactory()
 
     setEditorActionHandlers(TextEditorActionHandler::Format
                             | TextEditorActionHandler::UnCommentSelection
-                            | TextEditorActionHandler::UnCollapseAll);
+                            | TextEditorActionHandler::UnCollapseAll
+                            | TextEditorActionHandler::FindUsage
+                            | TextEditorActionHandler::FollowSymbolUnderCursor);
 
     setDocumentCreator([]() { return new UaisoEditorDocument; });
     setEditorWidgetCreator([]() { return new UaisoEditorWidget; });
@@ -164,7 +645,19 @@ UaisoEditorFactory::UaisoEditorFactory()
     //----------------//
 
 UaisoEditorDocument::UaisoEditorDocument()
-    : m_reports(nullptr)
+    : m_service(nullptr)
+    , m_reports(nullptr)
+    , m_contentKey(0)
+    , m_failedKey(0)
+    , m_publishedSignature(0)
+    , m_semanticRevision(0)
+    , m_highlightingCount(0)
+    , m_degraded(false)
+    , m_cached(false)
+    , m_viewportFirst(0)
+    , m_viewportLast(0)
+    , m_regionFirst(0)
+    , m_regionLast(-1)
 {
     setId(Constants::EDITOR_ID);
 
@@ -186,30 +679,24 @@ UaisoEditorDocument::UaisoEditorDocument()
 
 UaisoEditorDocument::~UaisoEditorDocument()
 {
-    if (m_watcher) {
-        disconnectWatcher();
-        m_watcher->cancel();
-        m_watcher->waitForFinished();
-    }
+    cancelSemanticData(true);
 }
 
 void UaisoEditorDocument::configure(const Utils::FileName &oldPath, const Utils::FileName &path)
 {
     Q_UNUSED(oldPath);
 
-    QFileInfo fileInfo = path.toFileInfo();
-    const QString& suffix = fileInfo.suffix();
-    if (suffix == QLatin1String("d"))
-        m_factory = uaiso::FactoryCreator::create(uaiso::LangId::D);
-    else if (suffix == QLatin1String("go"))
-        m_factory = uaiso::FactoryCreator::create(uaiso::LangId::Go);
-    else if (suffix == QLatin1String("py"))
-        m_factory = uaiso::FactoryCreator::create(uaiso::LangId::Py);
+    uaiso::LangId lang;
+    if (langIdForFile(path.toString(), &lang)) {
+        m_service = PLUGIN->registry()->service(lang);
+        m_factory = m_service->factory();
+    }
 
     m_unit = m_factory->makeUnit();
+    m_checker.reset(new IncrementalChecker(m_factory.get()));
 
     delete completionAssistProvider();
-    setCompletionAssistProvider(new UaisoAssistProvider(m_factory.get()));
+    setCompletionAssistProvider(new UaisoAssistProvider(m_service));
     setSyntaxHighlighter(new UaisoSyntaxHighlighter(m_factory.get()));
     setFilePath(path);
     updateFontSettings(fontSettings());
@@ -231,20 +718,77 @@ void UaisoEditorDocument::triggerAnalysis()
 {
     m_syntaxCheckTimer.start(kSyntaxCheckInterval);
     m_semanticCheckTimer.stop();
+
+    // Whatever is in flight is stale now.
+    m_cancellation.cancel();
 }
 
 void UaisoEditorDocument::parse()
 {
     m_syntaxCheckTimer.stop();
 
-    PLUGIN->tokens()->clear(filePath().toString().toStdString());
-    PLUGIN->lexemes()->clear(filePath().toString().toStdString());
+    const bool degraded =
+            document()->characterCount() > PLUGIN->largeFileThreshold() * 1024;
+    if (degraded != m_degraded) {
+        m_degraded = degraded;
+        updateDegradedInfo();
+    }
+
+    // Regions of a large file aren't worth remembering.
+    m_contentKey = m_degraded ? 0 : contentHash(filePath().toString(), plainText());
+    m_pendingResult.reset();
+    m_cached = false;
+    if (m_contentKey) {
+        if (const AnalysisResult* cached = PLUGIN->cachedResult(m_contentKey)) {
+            // The result stands for checking and collection, navigation and
+            // completion still need the AST and the program.
+            applyAnalysis(AnalysisResult(*cached));
+            m_cached = true;
+            parseInProcess();
+            return;
+        }
+        if (m_contentKey == m_failedKey) {
+            reportAnalyserFailure();
+            return;
+        }
+    }
+
+    if (!m_degraded && PLUGIN->remoteAnalyser()->isRunning())
+        analyseRemotely();
+    else
+        parseInProcess();
+}
+
+void UaisoEditorDocument::parseInProcess()
+{
+    // The collector works on the AST which is about to go.
+    cancelSemanticData(true);
+
+    // Maps of the program in the snapshot are kept by the module store.
+    m_parsed = std::make_shared<LoadedModule>();
+    m_parsed->m_fileName = filePath().toString();
 
-    std::string code = plainText().toStdString();
+    std::string code = m_degraded ? degradedSource() : plainText().toStdString();
     m_unit->assignInput(code);
     m_unit->setFileName(filePath().toString().toStdString());
-    m_unit->parse(PLUGIN->tokens(), PLUGIN->lexemes());
+    m_unit->parse(&m_parsed->m_tokens, &m_parsed->m_lexemes);
     m_reports.reset(m_unit->releaseReports());
+    if (m_cached) {
+        if (m_unit->ast())
+            m_semanticCheckTimer.start(kSemanticCheckInterval);
+        return;
+    }
+
+    m_diagnostics = diagnosticEntries(m_reports.get());
+    if (m_degraded) {
+        // The preamble is analysed along with every region, its diagnostics
+        // only count if it's part of the region.
+        auto outside = [this](const DiagnosticEntry& diagnostic) {
+            return diagnostic.m_line < m_regionFirst || diagnostic.m_line > m_regionLast;
+        };
+        m_diagnostics.erase(std::remove_if(m_diagnostics.begin(), m_diagnostics.end(), outside),
+                            m_diagnostics.end());
+    }
 
     emit requestDiagnosticsUpdate();
 
@@ -262,40 +806,236 @@ void UaisoEditorDocument::bindAndCheck()
 
     // Create symbols.
     uaiso::Binder binder(m_factory.get());
-    binder.setLexemes(PLUGIN->lexemes());
-    binder.setTokens(PLUGIN->tokens());
+    binder.setLexemes(&m_parsed->m_lexemes);
+    binder.setTokens(&m_parsed->m_tokens);
     binder.collectDiagnostics(m_reports.get());
     std::unique_ptr<uaiso::Program> prog(binder.bind(progAst, m_unit->fileName()));
 
     if (!prog || prog->env().isEmpty())
         return;
 
-    PLUGIN->snapshot().insertOrReplace(m_unit->fileName(), std::move(prog));
+    // A region's declarations would replace those of the whole file.
+    const QStringList& imports = importTargets(prog.get());
+    if (!m_degraded)
+        m_imports = imports;
+    QVector<DeclEntry> decls;
+    if (!m_degraded) {
+        decls = declEntries(prog.get());
+        PLUGIN->symbolIndex()->update(filePath().toString(), decls);
+        PLUGIN->declIndex()->update(filePath().toString(), decls);
+    }
+
+    // With the same declarations and imports, the program in the snapshot
+    // stays, dependants and dependencies see no change at all.
+    const QStringList& lines = plainText().split(QLatin1Char('\n'));
+    if (!m_degraded)
+        PLUGIN->signatureIndex()->update(filePath().toString(), decls, lines);
+    // A region's program isn't published either. An unpublished program is
+    // kept by the document, for as long as the AST refers to its symbols.
+    DependencyManager* deps = PLUGIN->dependencyManager(m_factory->langName());
+    QPointer<UaisoEditorDocument> self(this);
+    auto recheck = [self]() {
+        // Check again, against what was loaded.
+        if (self) {
+            self->m_cached = false;
+            self->m_semanticCheckTimer.start(kSemanticCheckInterval);
+        }
+    };
+    if (m_degraded) {
+        deps->processDeps(filePath().toString(), imports, recheck);
+    } else {
+        const quint64 signature = bindingSignature(decls, imports, lines);
+        if (signature != m_publishedSignature
+                || !PLUGIN->snapshot().find(m_unit->fileName())) {
+            PLUGIN->snapshot().insertOrReplace(m_unit->fileName(), std::move(prog));
+            PLUGIN->moduleStore()->keep(m_parsed);
+            m_publishedSignature = signature;
+
+            // Analyse dependencies, only those which are new or got invalidated.
+            deps->invalidate(filePath().toString());
+            deps->processDeps(filePath().toString(), imports, recheck);
+        }
+    }
+    if (prog)
+        m_parsed->m_prog = std::move(prog);
 
-    // Analyse dependencies.
-    uaiso::Manager manager;
-    manager.config(m_factory.get(),
-                   PLUGIN->tokens(),
-                   PLUGIN->lexemes(),
-                   PLUGIN->snapshot());
-    addSearchPaths(&manager, m_factory->langName());
-    manager.processDeps(m_unit->fileName());
+    // Diagnostics and references came from the cache.
+    if (m_cached)
+        return;
 
-    // Type checking.
-    uaiso::TypeChecker typeChecker(m_factory.get());
-    typeChecker.setLexemes(PLUGIN->lexemes());
-    typeChecker.setTokens(PLUGIN->tokens());
-    typeChecker.collectDiagnostics(m_reports.get());
-    typeChecker.check(Program_Cast(m_unit->ast()));
+    // Type checking, of edited declarations only if that's possible. A
+    // region has nothing to compare with.
+    m_diagnostics = diagnosticEntries(m_reports.get());
+    if (!m_degraded && m_checker->plan(lines)) {
+        m_diagnostics += m_checker->checkChanged(filePath().toString(), lines, decls);
+    } else {
+        const int bound = m_diagnostics.size();
+        uaiso::TypeChecker typeChecker(m_factory.get());
+        typeChecker.setLexemes(&m_parsed->m_lexemes);
+        typeChecker.setTokens(&m_parsed->m_tokens);
+        typeChecker.collectDiagnostics(m_reports.get());
+        typeChecker.check(Program_Cast(m_unit->ast()));
+        m_diagnostics = diagnosticEntries(m_reports.get());
+        if (m_degraded)
+            m_checker->reset();
+        else
+            m_checker->recordFull(m_diagnostics.mid(bound));
+    }
 
     emit requestDiagnosticsUpdate();
 
+    // Completed with the references once they're collected.
+    if (m_contentKey) {
+        m_pendingResult.reset(new AnalysisResult);
+        m_pendingResult->m_decls = decls;
+        m_pendingResult->m_diagnostics = m_diagnostics;
+        m_pendingResult->m_imports = imports;
+    }
+
     processSemanticData();
 }
 
+void UaisoEditorDocument::analyseRemotely()
+{
+    QPointer<UaisoEditorDocument> self(this);
+    const int revision = document()->revision();
+    const quint64 key = m_contentKey;
+    PLUGIN->remoteAnalyser()->analyse(
+                m_factory->langName(), filePath().toString(), plainText().toUtf8(),
+                [self, revision, key](UaisoRemoteAnalyser::Outcome outcome,
+                                      const AnalysisResult& result) {
+        if (!self || self->document()->revision() != revision)
+            return;
+        switch (outcome) {
+        case UaisoRemoteAnalyser::Analysed:
+            self->storeResult(key, result);
+            self->applyAnalysis(result);
+            break;
+
+        case UaisoRemoteAnalyser::Unavailable:
+            self->parseInProcess();
+            break;
+
+        case UaisoRemoteAnalyser::Crashed:
+            // Parsing in-process would likely take the IDE down with it.
+            self->m_failedKey = key;
+            self->reportAnalyserFailure();
+            break;
+        }
+    });
+}
+
+void UaisoEditorDocument::reportAnalyserFailure()
+{
+    cancelSemanticData(true);
+
+    DiagnosticEntry diagnostic;
+    diagnostic.m_line = 0;
+    diagnostic.m_col = 0;
+    diagnostic.m_lastCol = 0;
+    diagnostic.m_warning = true;
+    diagnostic.m_desc = tr("The analyser stopped while analysing this file, "
+                           "it's not analysed again until the file changes.");
+    m_diagnostics.clear();
+    m_diagnostics.append(diagnostic);
+    emit requestDiagnosticsUpdate();
+}
+
 
 namespace {
 
+// The plugin's DeclLookup, any thread may call it.
+QVector<DeclEntry> knownDecls(const QString& fileName)
+{
+    return UaisoEditorPlugin::instance()->declIndex()->decls(fileName);
+}
+
+QVector<HighlightingResult> highlightingResults(const QVector<SymbolRef>& refs)
+{
+    QVector<HighlightingResult> results;
+    results.reserve(refs.size());
+    for (const SymbolRef& ref : refs)
+        results.append(HighlightingResult(ref.m_line + 1, ref.m_col + 1, ref.m_length, ref.m_kind));
+
+    // Results are expected to be sorted.
+    std::sort(results.begin(), results.end(),
+              [](const HighlightingResult& a, const HighlightingResult& b) {
+        return a.line != b.line ? a.line < b.line : a.column < b.column;
+    }
+    );
+    return results;
+}
+
+/*!
+ * \brief collectByChunk
+ *
+ * References of a source gathered by top-level chunks, in parallel on
+ * \a pool, each one parsed and bound along with the declarations of the
+ * file it mentions (as of \a decls), and merged in document order.
+ *
+ * It's not the split of symbol collection itself: the engine's collector
+ * takes a whole AST, so chunks are parsed and bound again on their own.
+ * Declarations in a chunk's closure may be stale and references to what
+ * isn't top-level are missed, so it's a preview, quickly there, and the
+ * whole-file collector remains the one behind indexes and caches.
+ *
+ * Total work grows, every chunk parses the preamble and its closure again.
+ * The preview takes as long as the largest closure, so it only speeds up
+ * with cores while chunks refer to few others.
+ */
+QVector<SymbolRef> collectByChunk(QThreadPool* pool,
+                                  uaiso::Factory* factory,
+                                  const QStringList& lines,
+                                  const QString& fileName,
+                                  const QVector<DeclEntry>& decls,
+                                  const CancellationToken& token)
+{
+    SourceChunker chunker(factory);
+    chunker.split(lines, kPreviewChunkSize);
+    const QVector<SourceChunk>& chunks = chunker.chunks();
+
+    std::function<QVector<SymbolRef> (int)> collect = [&](int index) {
+        QVector<SymbolRef> refs;
+        if (token.isCanceled())
+            return refs;
+        const SourceChunk& chunk = chunks.at(index);
+
+        uaiso::TokenMap tokens;
+        uaiso::LexemeMap lexemes;
+        std::unique_ptr<uaiso::DiagnosticReports> reports;
+        std::unique_ptr<uaiso::Unit> unit =
+                parseSource(factory, fileName,
+                            chunker.compose(lines, chunker.withReferenced(
+                                                lines, QVector<int>() << index, decls)),
+                            &tokens, &lexemes, &reports);
+        uaiso::ProgramAst* progAst = Program_Cast(unit->ast());
+        if (!progAst)
+            return refs;
+        std::unique_ptr<uaiso::Program> prog =
+                bindProgram(factory, progAst, fileName, &tokens, &lexemes, reports.get());
+
+        // The preamble is in every chunk, it's taken from the first one.
+        // Other chunks around this one are there for their names only.
+        const int first = index == 0 ? 0 : chunk.m_firstLine;
+        for (const SymbolRef& ref :
+                 collectSymbolRefs(factory, progAst, &lexemes, fileName, &knownDecls, token)) {
+            if (ref.m_line >= first && ref.m_line <= chunk.m_lastLine)
+                refs.append(ref);
+        }
+        return refs;
+    };
+
+    QVector<int> indexes;
+    for (int i = 0; i < chunks.size(); ++i)
+        indexes.append(i);
+
+    // The caller is a task of the global pool, chunks go elsewhere.
+    QVector<SymbolRef> refs;
+    for (const QVector<SymbolRef>& chunkRefs : mapOn<QVector<SymbolRef>>(pool, indexes, collect))
+        refs += chunkRefs;
+    return refs;
+}
+
 class SymbolCollectorWrapper :
         public QRunnable,
         public QFutureInterface<TextEditor::HighlightingResult>
@@ -303,38 +1043,42 @@ class SymbolCollectorWrapper :
 private:
     uaiso::Factory* m_factory { nullptr };
     uaiso::ProgramAst* m_progAst { nullptr } ;
+    std::shared_ptr<LoadedModule> m_parsed;
+    CancellationToken m_token;
+    std::shared_ptr<AnalysisResult> m_result;
+    bool m_indexUsages { true };
 
 public:
     SymbolCollectorWrapper(uaiso::Factory* factory,
-                           uaiso::ProgramAst* progAst)
-        : m_factory(factory), m_progAst(progAst)
+                           uaiso::ProgramAst* progAst,
+                           const std::shared_ptr<LoadedModule>& parsed,
+                           const CancellationToken& token,
+                           const std::shared_ptr<AnalysisResult>& result,
+                           bool indexUsages)
+        : m_factory(factory), m_progAst(progAst), m_parsed(parsed), m_token(token)
+        , m_result(result), m_indexUsages(indexUsages)
     {}
 
     void run()
     {
-        uaiso::SymbolCollector collector(m_factory);
-        auto refs = collector.collect(m_progAst, PLUGIN->lexemes());
-
-        if (!refs.empty()) {
-            QVector<HighlightingResult> results;
-            for (auto ref : refs) {
-                auto sym = std::get<1>(ref);
-                auto loc = std::get<2>(ref);
-                HighlightingResult result(loc.line_ + 1, loc.col_ + 1,
-                                          loc.lastCol_ - loc.col_,
-                                          static_cast<int>(sym->kind()));
-                results.append(result);
-            }
-
-            // Results are expected to be sorted.
-            std::sort(results.begin(), results.end(),
-                      [](const HighlightingResult& a, const HighlightingResult& b) {
-                return a.line != b.line ? a.line < b.line : a.column < b.column;
-            }
-            );
-            reportResults(results);
+        // References are kept for find usages.
+        const QVector<SymbolRef>& refs =
+                collectSymbolRefs(m_factory, m_progAst, &m_parsed->m_lexemes,
+                                  m_parsed->m_fileName, &knownDecls, m_token);
+        if (isCanceled() || m_token.isCanceled()) {
+            reportFinished();
+            return;
         }
 
+        // A region's references would replace those of the whole file.
+        if (m_indexUsages)
+            PLUGIN->usageIndex()->update(m_parsed->m_fileName, refs);
+        if (m_result)
+            m_result->m_refs = refs;
+
+        if (!refs.empty())
+            reportResults(highlightingResults(refs));
+
         reportFinished();
     }
 
@@ -355,10 +1099,8 @@ public:
 
 void UaisoEditorDocument::processSemanticData()
 {
-    if (m_watcher) {
-        disconnectWatcher();
-        m_watcher->cancel();
-    }
+    cancelSemanticData(false);
+    m_cancellation = CancellationToken();
 
     m_semanticRevision = document()->revision();
     m_watcher.reset(new QFutureWatcher<TextEditor::HighlightingResult>);
@@ -368,8 +1110,165 @@ void UaisoEditorDocument::processSemanticData()
             this, SLOT(semanticDataFinished()));
 
     SymbolCollectorWrapper *collector =
-            new SymbolCollectorWrapper(m_factory.get(), Program_Cast(m_unit->ast()));
+            new SymbolCollectorWrapper(m_factory.get(), Program_Cast(m_unit->ast()),
+                                       m_parsed, m_cancellation, m_pendingResult,
+                                       !m_degraded);
     m_watcher->setFuture(collector->start());
+
+    // The collector walks the whole AST on a single thread. Big files get
+    // preliminary colours from their chunks collected on the other cores.
+    if (m_degraded || document()->blockCount() < kPreviewLines)
+        return;
+
+    m_previewWatcher.reset(new QFutureWatcher<QVector<SymbolRef>>);
+    connect(m_previewWatcher.get(), SIGNAL(finished()), this, SLOT(previewFinished()));
+    std::shared_ptr<uaiso::Factory> factory = m_factory;
+    const QStringList& lines = plainText().split(QLatin1Char('\n'));
+    const QString& fileName = filePath().toString();
+    const QVector<DeclEntry>& decls = knownDecls(fileName);
+    const CancellationToken token = m_cancellation;
+    QThreadPool* pool = PLUGIN->chunkPool();
+    m_previewWatcher->setFuture(QtConcurrent::run([pool, factory, lines, fileName, decls, token]() {
+        return collectByChunk(pool, factory.get(), lines, fileName, decls, token);
+    }));
+}
+
+void UaisoEditorDocument::previewFinished()
+{
+    std::unique_ptr<QFutureWatcher<QVector<SymbolRef>>> watcher(std::move(m_previewWatcher));
+
+    // Once the collector has results, they're the ones to show.
+    if (!watcher
+            || document()->revision() != m_semanticRevision
+            || !m_watcher
+            || m_watcher->future().resultCount() > 0) {
+        return;
+    }
+
+    applyHighlighting(watcher->result());
+}
+
+void UaisoEditorDocument::applyAnalysis(const AnalysisResult &result)
+{
+    m_diagnostics = result.m_diagnostics;
+    emit requestDiagnosticsUpdate();
+
+    const QString& fileName = filePath().toString();
+    PLUGIN->symbolIndex()->update(fileName, result.m_decls);
+    PLUGIN->declIndex()->update(fileName, result.m_decls);
+    PLUGIN->signatureIndex()->update(fileName, result.m_decls,
+                                     plainText().split(QLatin1Char('\n')));
+    PLUGIN->usageIndex()->update(fileName, result.m_refs);
+
+    // The analyser loaded the dependencies in its own snapshot, completion
+    // and navigation need them in ours. The document's own program isn't
+    // published, there's none in this process.
+    m_imports = result.m_imports;
+    DependencyManager* deps = PLUGIN->dependencyManager(m_factory->langName());
+    deps->invalidate(fileName);
+    deps->processDeps(fileName, m_imports);
+
+    cancelSemanticData(false);
+    applyHighlighting(result.m_refs);
+}
+
+void UaisoEditorDocument::applyHighlighting(const QVector<SymbolRef> &refs)
+{
+    // Results are all there already, hand them over as a finished future.
+    const QVector<HighlightingResult>& results = highlightingResults(refs);
+    QFutureInterface<HighlightingResult> future;
+    future.reportStarted();
+    future.reportResults(results);
+    future.reportFinished();
+
+    SyntaxHighlighter *highlighter = syntaxHighlighter();
+    QTC_CHECK(highlighter);
+    SemanticHighlighter::incrementalApplyExtraAdditionalFormats(
+                highlighter, future.future(), 0, results.size(), m_kindToFormat);
+    SemanticHighlighter::clearExtraAdditionalFormatsUntilEnd(highlighter, future.future());
+    m_highlightingCount = results.size();
+}
+
+void UaisoEditorDocument::storeResult(quint64 key, const AnalysisResult &result)
+{
+    PLUGIN->cacheResult(key, result);
+
+    // What's kept across sessions must match the file on disk.
+    if (!isModified())
+        PLUGIN->sessionCache()->record(filePath().toString(), key, result);
+}
+
+void UaisoEditorDocument::setViewport(int firstLine, int lastLine)
+{
+    m_viewportFirst = firstLine;
+    m_viewportLast = lastLine;
+
+    if (m_degraded && (firstLine < m_regionFirst || lastLine > m_regionLast))
+        m_syntaxCheckTimer.start(kSyntaxCheckInterval);
+}
+
+std::string UaisoEditorDocument::degradedSource()
+{
+    const QStringList& lines = plainText().split(QLatin1Char('\n'));
+    SourceChunker chunker(m_factory.get());
+    chunker.split(lines, kChunkSize);
+
+    // Take whole chunks covering the viewport and its margin.
+    const int first = std::max(0, m_viewportFirst - kViewportMargin);
+    const int last = m_viewportLast + kViewportMargin;
+    m_regionFirst = 0;
+    m_regionLast = chunker.preambleEnd() - 1;
+    bool found = false;
+    for (const SourceChunk& chunk : chunker.chunks()) {
+        if (chunk.m_lastLine < first || chunk.m_firstLine > last)
+            continue;
+        if (!found) {
+            m_regionFirst = chunk.m_firstLine;
+            found = true;
+        }
+        m_regionLast = chunk.m_lastLine;
+    }
+    if (m_regionFirst < chunker.preambleEnd())
+        m_regionFirst = 0;
+
+    return chunker.compose(lines, m_regionFirst, m_regionLast);
+}
+
+void UaisoEditorDocument::updateDegradedInfo()
+{
+    const Core::Id id(Constants::DEGRADED_INFO_ID);
+    if (!m_degraded) {
+        infoBar()->removeInfo(id);
+        return;
+    }
+
+    if (infoBar()->canInfoBeAdded(id)) {
+        infoBar()->addInfo(Core::InfoBarEntry(
+                id,
+                tr("This file is larger than %1 KB. Only the declarations around "
+                   "the visible area are analysed, and the file isn't type-checked "
+                   "as a whole.").arg(PLUGIN->largeFileThreshold())));
+    }
+}
+
+void UaisoEditorDocument::cancelSemanticData(bool wait)
+{
+    m_cancellation.cancel();
+
+    // The preview works on copies, it's left to finish on its own.
+    if (m_previewWatcher) {
+        disconnect(m_previewWatcher.get(), SIGNAL(finished()), this, SLOT(previewFinished()));
+        m_previewWatcher.reset();
+    }
+
+    if (!m_watcher)
+        return;
+
+    disconnectWatcher();
+    m_watcher->cancel();
+    if (wait)
+        m_watcher->waitForFinished();
+    m_watcher.reset();
 }
 
 void UaisoEditorDocument::disconnectWatcher()
@@ -402,7 +1301,11 @@ void UaisoEditorDocument::semanticDataFinished()
         QTC_CHECK(highlighter);
         SemanticHighlighter::clearExtraAdditionalFormatsUntilEnd(
                highlighter, m_watcher->future());
+        m_highlightingCount = m_watcher->future().resultCount();
+        if (m_pendingResult)
+            storeResult(m_contentKey, *m_pendingResult);
     }
+    m_pendingResult.reset();
     m_watcher.reset();
 }
 
@@ -432,11 +1335,17 @@ UaisoEditorWidget::createAssistInterface(AssistKind kind,
 {
     if (kind == Completion) {
         auto doc = static_cast<UaisoEditorDocument*>(textDocument());
-        return new UaisoAssistInterface(document(),
-                                        position(),
-                                        textDocument()->filePath().toString(),
-                                        reason,
-                                        doc->m_factory.get());
+        auto interface = new UaisoAssistInterface(document(),
+                                                  position(),
+                                                  textDocument()->filePath().toString(),
+                                                  reason,
+                                                  doc->m_service);
+        if (doc->m_service) {
+            interface->m_searchPaths = searchPathsFor(doc->m_service->factory()->langName());
+            interface->m_loader = PLUGIN->dependencyManager(doc->m_service->langId())->loader();
+            interface->m_imports = doc->m_imports;
+        }
+        return interface;
     }
     return TextEditorWidget::createAssistInterface(kind, reason);
 }
@@ -447,25 +1356,149 @@ void UaisoEditorWidget::finalizeInitialization()
 
     connect(doc, SIGNAL(requestDiagnosticsUpdate()),
             this, SLOT(updateDiagnostics()));
+    connect(verticalScrollBar(), SIGNAL(valueChanged(int)),
+            this, SLOT(updateViewport()));
+
+    // Once the user pauses, what's likely to be completed next is computed.
+    m_prefetchTimer.setSingleShot(true);
+    m_prefetchTimer.setInterval(kPrefetchDelay);
+    connect(&m_prefetchTimer, SIGNAL(timeout()), this, SLOT(prefetchCompletion()));
+    connect(this, SIGNAL(cursorPositionChanged()), &m_prefetchTimer, SLOT(start()));
 }
 
-void UaisoEditorWidget::updateDiagnostics()
+void UaisoEditorWidget::prefetchCompletion()
 {
     UaisoEditorDocument* doc = static_cast<UaisoEditorDocument*>(textDocument());
-    if (!doc->m_reports)
+    if (doc->isDegraded() || textCursor().hasSelection() || !doc->m_service)
         return;
 
+    const QString& fileName = doc->filePath().toString();
+    const QStringList& searchPaths = searchPathsFor(doc->m_service->factory()->langName());
+    PLUGIN->completionScheduler()->prefetch(
+                fileName, doc->document()->revision(),
+                CompletionScheduler::speculate(doc->m_service, fileName, doc->plainText(),
+                                               position(), doc->m_imports, searchPaths));
+}
+
+void UaisoEditorWidget::updateViewport()
+{
+    UaisoEditorDocument* doc = static_cast<UaisoEditorDocument*>(textDocument());
+    const int first = firstVisibleBlock().blockNumber();
+    const int last = cursorForPosition(viewport()->rect().bottomLeft()).blockNumber();
+    doc->setViewport(first, last);
+}
+
+void UaisoEditorWidget::findUsages()
+{
+    UaisoEditorDocument* doc = static_cast<UaisoEditorDocument*>(textDocument());
+    const QTextCursor& cursor = textCursor();
+
+    // One version for both lookups, the index may be updated meanwhile.
+    const UsageIndex::View usages = PLUGIN->usageIndex()->view();
+    SymbolKey key;
+    if (!usages.symbolAt(doc->filePath().toString(),
+                         cursor.blockNumber(),
+                         cursor.positionInBlock(),
+                         &key)) {
+        return;
+    }
+
+    QTextCursor word(cursor);
+    word.select(QTextCursor::WordUnderCursor);
+    Core::SearchResult *search = Core::SearchResultWindow::instance()->startNewSearch(
+                tr("Uaiso Usages"), QString(), word.selectedText(),
+                Core::SearchResultWindow::SearchOnly);
+    connect(search, &Core::SearchResult::activated,
+            [](const Core::SearchResultItem& item) {
+        Core::EditorManager::openEditorAtSearchResult(item);
+    });
+
+    // Lines come from the open document when there's one, otherwise from disk.
+    QHash<QString, QStringList> lines;
+    for (const auto& usage : usages.usages(key)) {
+        const QString& fileName = usage.first;
+        if (!lines.contains(fileName)) {
+            QString text;
+            if (fileName == doc->filePath().toString()) {
+                text = doc->plainText();
+            } else {
+                QFile file(fileName);
+                if (file.open(QIODevice::ReadOnly | QIODevice::Text))
+                    text = QString::fromUtf8(file.readAll());
+            }
+            lines.insert(fileName, text.split(QLatin1Char('\n')));
+        }
+        const SymbolRef& ref = usage.second;
+        search->addResult(fileName, ref.m_line + 1,
+                          lines.value(fileName).value(ref.m_line),
+                          ref.m_col, ref.m_length);
+    }
+
+    search->finishSearch(false);
+    Core::SearchResultWindow::instance()->popup(Core::IOutputPane::ModeSwitch
+                                                | Core::IOutputPane::WithFocus);
+}
+
+TextEditorWidget::Link UaisoEditorWidget::findLinkAt(const QTextCursor &cursor,
+                                                     bool resolveTarget,
+                                                     bool inNextSplit)
+{
+    Q_UNUSED(inNextSplit);
+
+    QTextCursor word(cursor);
+    word.select(QTextCursor::WordUnderCursor);
+    const QString& name = word.selectedText();
+    if (name.isEmpty())
+        return Link();
+
+    Link link;
+    link.linkTextStart = word.selectionStart();
+    link.linkTextEnd = word.selectionEnd();
+    if (!resolveTarget)
+        return link;
+
+    auto doc = static_cast<UaisoEditorDocument*>(textDocument());
+    if (!doc->m_service)
+        return Link();
+    SymbolKey key;
+    if (!resolveSymbol(doc->m_service,
+                       PLUGIN->dependencyManager(doc->m_service->langId())->loader().get(),
+                       doc->filePath().toString(), doc->m_imports,
+                       cursor.blockNumber(), cursor.positionInBlock(), name, &key)) {
+        return Link();
+    }
+
+    // A top-level declaration may have moved since the reference was
+    // collected, its table has where it is now.
+    SymbolKey current;
+    if (key.m_scope.isEmpty()
+            && PLUGIN->declIndex()->find(key.m_fileName, key.m_name, &current)
+            && current == key) {
+        key = current;
+    }
+
+    // Uaiso's lines are 0-based, the editor's are 1-based.
+    link.targetFileName = key.m_fileName;
+    link.targetLine = key.m_line + 1;
+    link.targetColumn = key.m_col;
+    return link;
+}
+
+void UaisoEditorWidget::updateDiagnostics()
+{
+    UaisoEditorDocument* doc = static_cast<UaisoEditorDocument*>(textDocument());
+
     QList<QTextEdit::ExtraSelection> selecs;
-    for (const uaiso::DiagnosticReport& report : *doc->m_reports) {
-        const int line = report.sourceLoc().line_;
-        const int column = report.sourceLoc().col_;
+    for (const DiagnosticEntry& diagnostic : doc->m_diagnostics) {
+        const int line = diagnostic.m_line;
+        const int column = diagnostic.m_col;
 
         QTextEdit::ExtraSelection selec;
         QTextCursor c(document()->findBlockByNumber(line));
         selec.cursor = c;
         selec.cursor.setPosition(c.position() + column);
 
-        int length = report.sourceLoc().lastCol_ - report.sourceLoc().col_;
+        int length = diagnostic.m_lastCol - diagnostic.m_col;
         if (!length) {
             if (selec.cursor.atBlockEnd())
                 selec.cursor.movePosition(QTextCursor::StartOfWord,
@@ -478,13 +1511,13 @@ void UaisoEditorWidget::updateDiagnostics()
                                       QTextCursor::KeepAnchor, length);
         }
 
-        if (report.diagnostic().severity() == uaiso::Severity::Warning)
+        if (diagnostic.m_warning)
             selec.format.setUnderlineColor(Qt::darkYellow);
         else
             selec.format.setUnderlineColor(Qt::red);
 
         selec.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
-        selec.format.setToolTip(QString::fromStdString(report.diagnostic().desc()));
+        selec.format.setToolTip(diagnostic.m_desc);
 
         selecs.append(selec);
     }
@@ -576,14 +1609,63 @@ void UaisoHoverHandler::identifyMatch(TextEditorWidget *widget, int pos)
     }
 }
 
-void UaisoQtc::addSearchPaths(uaiso::Manager* manager, uaiso::LangId lang)
+QStringList UaisoQtc::searchPathsFor(uaiso::LangId lang)
 {
     UaisoSettings settings;
     settings.load(Core::ICore::settings());
     QString paths = settings.m_options[static_cast<int>(lang)].m_systemPaths;
-    if (!paths.isEmpty()) {
-        const QStringList& pathList = paths.split(QLatin1Char(':'));
-        foreach (const QString& path, pathList)
-            manager->addSearchPath(path.toStdString());
+    QStringList searchPaths;
+    if (!paths.isEmpty())
+        searchPaths = paths.split(QLatin1Char(':'));
+
+    // Then whatever the interpreter itself searches.
+    if (lang == uaiso::LangId::Py && PLUGIN) {
+        for (const QString& path : PLUGIN->interpreterPaths()) {
+            if (!searchPaths.contains(path))
+                searchPaths.append(path);
+        }
     }
+    return searchPaths;
+}
+
+QStringList UaisoQtc::moduleFiles(const LangService* service,
+                                  const ModuleLoader* loader,
+                                  const QString& fileName,
+                                  const QStringList& imports)
+{
+    QStringList files;
+    for (const QString& import : imports)
+        files += loader->resolve(import, fileName);
+    for (const QString& import : service->preludeModules())
+        files += loader->resolve(import, QString());
+    files.removeAll(fileName);
+    files.removeDuplicates();
+    return files;
+}
+
+bool UaisoQtc::resolveSymbol(const LangService* service,
+                             const ModuleLoader* loader,
+                             const QString& fileName,
+                             const QStringList& imports,
+                             int line, int col,
+                             const QString& name,
+                             SymbolKey* key)
+{
+    // Modules are only resolved if it comes to them, in import order and
+    // the prelude last.
+    UaisoEditorPlugin* plugin = UaisoEditorPlugin::instance();
+    if (plugin->usageIndex()->symbolAt(fileName, line, col, key))
+        return true;
+    if (plugin->declIndex()->lookup(fileName, name, key))
+        return true;
+    for (const QString& other : moduleFiles(service, loader, fileName, imports)) {
+        if (plugin->declIndex()->lookup(other, name, key))
+            return true;
+    }
+    return false;
+}
+
+void UaisoQtc::addSearchPaths(uaiso::Manager* manager, uaiso::LangId lang)
+{
+    addSearchPaths(manager, searchPathsFor(lang));
 }
@@ -30,10 +30,18 @@
 
 #include <QtPlugin>
 #include <QAction>
+#include <QCache>
+#include <QFileSystemWatcher>
+#include <QFuture>
 #include <QFutureWatcher>
+#include <QMutex>
 #include <QScopedPointer>
+#include <QSet>
+#include <QThreadPool>
 #include <QTimer>
 
+#include <unordered_map>
+
     /* Uaiso - https://github.com/ltcmelo/uaiso
      *
      * Notice: This implementation has the only purpose of showcasing a few
@@ -42,11 +50,15 @@
      * not even complete. The primary concern is to demonstrate Uaiso's API.
      */
 
+#include "uaisopipeline.h"
+
 #include <Parsing/LangId.h>
 #include <Parsing/LexemeMap.h>
 #include <Parsing/TokenMap.h>
 #include <Semantic/Snapshot.h>
 
+namespace Core { class IEditor; }
+
 namespace uaiso {
 
 class DiagnosticReports;
@@ -59,14 +71,59 @@ class Unit;
 
 namespace UaisoQtc {
 
+class DeclIndex;
+class DependencyManager;
+class GoPackageIndex;
+class IncrementalChecker;
+class LangRegistry;
+class LangService;
+struct LoadedModule;
+class ModuleLoader;
+class ModuleStore;
+class PythonStubIndex;
+class SessionCache;
+class SignatureIndex;
+class SymbolIndex;
+class UsageIndex;
+class CompletionScheduler;
+class UaisoMemoryPane;
+class UaisoRemoteAnalyser;
 class UaisoSettingsPage;
 
     //--------------//
     //--- Plugin ---//
     //--------------//
 
+QStringList searchPathsFor(uaiso::LangId lang);
 void addSearchPaths(uaiso::Manager* manager, uaiso::LangId);
 
+/*!
+ * \brief moduleFiles
+ *
+ * The files the \a imports of \a fileName resolve to, then those of the
+ * language's prelude. It touches the file system, but not the snapshot.
+ */
+QStringList moduleFiles(const LangService* service,
+                        const ModuleLoader* loader,
+                        const QString& fileName,
+                        const QStringList& imports);
+
+/*!
+ * \brief resolveSymbol
+ *
+ * What \a name at \a line and \a col of \a fileName is declared as, as far
+ * as the indexes know: the reference map from the last symbol collection,
+ * then the file's declarations, then those of its modules. Only indexes are
+ * read, any thread may call it.
+ */
+bool resolveSymbol(const LangService* service,
+                   const ModuleLoader* loader,
+                   const QString& fileName,
+                   const QStringList& imports,
+                   int line, int col,
+                   const QString& name,
+                   SymbolKey* key);
+
 class UaisoEditorPlugin : public ExtensionSystem::IPlugin
 {
     Q_OBJECT
@@ -80,12 +137,103 @@ public:
 
     bool initialize(const QStringList &arguments, QString *errorMessage = 0);
     void extensionsInitialized();
+    ShutdownFlag aboutToShutdown();
 
     uaiso::LexemeMap *lexemes() { return &m_lexemes; }
     uaiso::TokenMap *tokens() { return &m_tokens; }
     uaiso::Snapshot snapshot() { return m_snapshot; }
 
+    /*!
+     * \brief snapshotFiles
+     *
+     * Files with a program in the snapshot: documents and the modules loaded
+     * for them, except those left to the Managers (see unresolvedImports).
+     */
+    QStringList snapshotFiles() const;
+    QStringList unresolvedImports() const;
+
+    SymbolIndex* symbolIndex() { return m_symbolIndex.get(); }
+    UsageIndex* usageIndex() { return m_usageIndex.get(); }
+    DeclIndex* declIndex() { return m_declIndex.get(); }
+    SignatureIndex* signatureIndex() { return m_signatureIndex.get(); }
+    GoPackageIndex* goPackageIndex() { return m_goIndex.get(); }
+
+    LangRegistry* registry() { return m_registry.get(); }
+
+    /*!
+     * \brief cachedResult
+     *
+     * Analysis of contents seen before, keyed by contentHash. Returning to
+     * them (undo, revert, reopen) needs no parsing at all. GUI thread only.
+     * The session's previous results are restored on first lookup.
+     */
+    const AnalysisResult* cachedResult(quint64 key);
+    void cacheResult(quint64 key, const AnalysisResult& result);
+
+    SessionCache* sessionCache() { return m_sessionCache.get(); }
+
+    // In KB, documents above it are analysed in degraded mode.
+    int largeFileThreshold() const { return m_largeFileThreshold; }
+    void setLargeFileThreshold(int threshold) { m_largeFileThreshold = threshold; }
+
+    /*!
+     * \brief dependencyManager
+     *
+     * The language's long-lived Manager, working on the plugin's snapshot.
+     * Reset it when search paths change.
+     */
+    DependencyManager* dependencyManager(uaiso::LangId lang);
+    ModuleStore* moduleStore() { return m_moduleStore.get(); }
+    void resetDependencyManagers();
+
+    /*!
+     * \brief interpreterPaths
+     *
+     * The sys.path of the configured Python interpreter, once it's been run.
+     * Thread-safe.
+     */
+    QStringList interpreterPaths() const;
+
+    /*!
+     * \brief updatePythonEnvironment
+     *
+     * Run the interpreter again if the settings name another one.
+     */
+    void updatePythonEnvironment();
+
+    /*!
+     * \brief updateGoIndex
+     *
+     * Scan Go packages again, search paths are among the places looked at.
+     */
+    void updateGoIndex();
+
+    /*!
+     * \brief chunkPool
+     *
+     * For work fanned out by tasks already running in the global pool.
+     */
+    QThreadPool* chunkPool() { return &m_chunkPool; }
+
     UaisoSettingsPage* settingsPage();
+    UaisoMemoryPane* memoryPane();
+    UaisoRemoteAnalyser* remoteAnalyser();
+    CompletionScheduler* completionScheduler();
+
+private slots:
+    void warmUp();
+    void saveSession();
+    void resetSession();
+    void refreshStubs();
+    void buildGoIndex();
+    void editorsClosed(const QList<Core::IEditor*>& editors);
+    void documentRenamed(const QString& from, const QString& to);
+
+private:
+    void restoreSession();
+    void forgetFile(const QString& fileName);
+    void warmUpLang(uaiso::LangId lang);
+    void retryFailedImports(uaiso::LangId lang);
 
 private:
     static UaisoEditorPlugin *m_instance;
@@ -93,8 +241,34 @@ private:
     uaiso::LexemeMap m_lexemes;
     uaiso::TokenMap m_tokens;
     uaiso::Snapshot m_snapshot;
+    std::unique_ptr<SymbolIndex> m_symbolIndex;
+    std::unique_ptr<UsageIndex> m_usageIndex;
+    std::unique_ptr<DeclIndex> m_declIndex;
+    std::unique_ptr<SignatureIndex> m_signatureIndex;
+    std::unique_ptr<LangRegistry> m_registry;
+    std::unique_ptr<ModuleStore> m_moduleStore;
+    std::unordered_map<int, std::unique_ptr<DependencyManager>> m_deps;
+    QCache<quint64, AnalysisResult> m_resultCache;
+    std::unique_ptr<SessionCache> m_sessionCache;
+    bool m_sessionRestored;
+    mutable QMutex m_pythonLock;
+    QString m_interpreter;
+    QStringList m_interpreterPaths;
+    std::unique_ptr<PythonStubIndex> m_stubIndex;
+    QFileSystemWatcher m_siteWatcher;
+    QTimer m_stubTimer;
+    QFuture<void> m_stubRefresh;
+    std::unique_ptr<GoPackageIndex> m_goIndex;
+    QTimer m_goIndexTimer;
+    QFuture<void> m_goIndexBuild;
+    CancellationToken m_indexCancellation;
+    QThreadPool m_chunkPool;
 
     UaisoSettingsPage* m_settingsPage;
+    UaisoMemoryPane* m_memoryPane;
+    UaisoRemoteAnalyser* m_remoteAnalyser;
+    CompletionScheduler* m_completionScheduler;
+    int m_largeFileThreshold;
 };
 
     //---------------//
@@ -121,12 +295,37 @@ public:
     explicit UaisoEditorDocument();
     ~UaisoEditorDocument();
 
+    int highlightingCount() const { return m_highlightingCount; }
+
+    /*!
+     * \brief setViewport
+     *
+     * In degraded mode only the declarations around the viewport are
+     * analysed, and there's no whole-file type checking.
+     */
+    void setViewport(int firstLine, int lastLine);
+    bool isDegraded() const { return m_degraded; }
+
     QTimer m_syntaxCheckTimer;
     QTimer m_semanticCheckTimer;
-    std::unique_ptr<uaiso::Factory> m_factory;
+    const LangService* m_service;
+    std::shared_ptr<uaiso::Factory> m_factory;
     std::unique_ptr<uaiso::Unit> m_unit;
     std::unique_ptr<uaiso::DiagnosticReports> m_reports;
+    QVector<DiagnosticEntry> m_diagnostics;
+    CancellationToken m_cancellation;
+    quint64 m_contentKey;
+    quint64 m_failedKey; // Content the analyser couldn't get through.
+    std::shared_ptr<AnalysisResult> m_pendingResult;
+    std::unique_ptr<IncrementalChecker> m_checker;
+
+    // Tokens and lexemes of m_unit. The program in the snapshot is only
+    // replaced when its declarations or imports change.
+    std::shared_ptr<LoadedModule> m_parsed;
+    quint64 m_publishedSignature;
+    QStringList m_imports; // As of the last binding or analysis, for completion.
     std::unique_ptr<QFutureWatcher<TextEditor::HighlightingResult>> m_watcher;
+    std::unique_ptr<QFutureWatcher<QVector<SymbolRef>>> m_previewWatcher;
 
 signals:
     void requestDiagnosticsUpdate();
@@ -144,12 +343,34 @@ private slots:
     // Symbols info.
     void semanticDataAvailable(int from, int to);
     void semanticDataFinished();
+    void previewFinished();
 
 private:
     void disconnectWatcher();
+    void cancelSemanticData(bool wait);
+    void applyHighlighting(const QVector<SymbolRef>& refs);
+
+    // Out-of-process analysis.
+    void analyseRemotely();
+    void applyAnalysis(const AnalysisResult& result);
+    void parseInProcess();
+    void reportAnalyserFailure();
+
+    void storeResult(quint64 key, const AnalysisResult& result);
+
+    // Large files.
+    std::string degradedSource();
+    void updateDegradedInfo();
 
     QHash<int, QTextCharFormat> m_kindToFormat;
     int m_semanticRevision;
+    int m_highlightingCount;
+    bool m_degraded;
+    bool m_cached; // Checking and collection are covered by a cached result.
+    int m_viewportFirst;
+    int m_viewportLast;
+    int m_regionFirst;
+    int m_regionLast;
 };
 
     //--------------//
@@ -183,8 +404,22 @@ public:
 
     void finalizeInitialization();
 
+    void findUsages() Q_DECL_OVERRIDE;
+
+protected:
+    Link findLinkAt(const QTextCursor &cursor,
+                    bool resolveTarget = true,
+                    bool inNextSplit = false) Q_DECL_OVERRIDE;
+
 public slots:
     void updateDiagnostics();
+
+private slots:
+    void updateViewport();
+    void prefetchCompletion();
+
+private:
+    QTimer m_prefetchTimer;
 };
 
     //------------------------//
@@ -237,6 +472,11 @@ const char SETTINGS_CATEGORY[] = "AA.Uaiso";
 const char SETTINGS_TR_CATEGORY[] = QT_TRANSLATE_NOOP("Uaiso", "Uaiso");
 const char SETTINGS_CATEGORY_ICON[] = ":/uaiso/images/uaiso.png";
 
+const char MENU_ID[] = "UaisoEditor.Menu";
+const char DUMP_MEMORY_ACTION_ID[] = "UaisoEditor.DumpMemory";
+const char LOCATOR_FILTER_ID[] = "UaisoEditor.SymbolFilter";
+const char DEGRADED_INFO_ID[] = "UaisoEditor.DegradedMode";
+
 } // namespace Constants
 
 } // namespace UaisoQtc
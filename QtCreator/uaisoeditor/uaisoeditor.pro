@@ -6,14 +6,50 @@ INCLUDEPATH += $$(UAISO_PATH)/External
 
 include(../../qtcreatorplugin.pri)
 
+QT += network
+
 HEADERS += \
     uaisoeditor.h \
+    uaisochecker.h \
+    uaisochunker.h \
     uaisocompletion.h \
+    uaisodependencies.h \
+    uaisofuzzymatcher.h \
+    uaisogo.h \
+    uaisoindex.h \
+    uaisointerner.h \
+    uaisoloader.h \
+    uaisolocator.h \
+    uaisomappedfile.h \
+    uaisomemory.h \
+    uaisopipeline.h \
+    uaisoprotocol.h \
+    uaisopython.h \
+    uaisoregistry.h \
+    uaisoremote.h \
+    uaisosession.h \
     uaisosettings.h
 
 SOURCES += \
     uaisoeditor.cpp \
+    uaisochecker.cpp \
+    uaisochunker.cpp \
     uaisocompletion.cpp \
+    uaisodependencies.cpp \
+    uaisofuzzymatcher.cpp \
+    uaisogo.cpp \
+    uaisoindex.cpp \
+    uaisointerner.cpp \
+    uaisoloader.cpp \
+    uaisolocator.cpp \
+    uaisomappedfile.cpp \
+    uaisomemory.cpp \
+    uaisopipeline.cpp \
+    uaisoprotocol.cpp \
+    uaisopython.cpp \
+    uaisoregistry.cpp \
+    uaisoremote.cpp \
+    uaisosession.cpp \
     uaisosettings.cpp
 
 RESOURCES += \
@@ -0,0 +1,314 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisofuzzymatcher.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#  define UAISO_QTC_SSE2
+#  include <emmintrin.h>
+#  ifdef _MSC_VER
+#    include <intrin.h>
+#  endif
+#endif
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+
+namespace {
+
+const int kExactBonus = 40;
+const int kPrefixBonus = 20;
+const int kStartBonus = 8;
+const int kBoundaryBonus = 6;
+const int kConsecutiveBonus = 4;
+const int kCaseBonus = 1;
+const int kGapPenalty = 1;
+const int kMaxGapPenalty = 12;
+const int kKindWeight = 2;
+const int kDistanceWeight = 3;
+
+char toLower(char ch)
+{
+    return (ch >= 'A' && ch <= 'Z') ? ch - 'A' + 'a' : ch;
+}
+
+bool isUpper(char ch)
+{
+    return ch >= 'A' && ch <= 'Z';
+}
+
+uint64_t charBit(char ch)
+{
+    ch = toLower(ch);
+    if (ch >= 'a' && ch <= 'z')
+        return uint64_t(1) << (ch - 'a');
+    if (ch >= '0' && ch <= '9')
+        return uint64_t(1) << (26 + ch - '0');
+    if (ch == '_')
+        return uint64_t(1) << 36;
+    return uint64_t(1) << (37 + static_cast<unsigned char>(ch) % 27);
+}
+
+uint64_t charMask(const char* s, size_t length)
+{
+    uint64_t mask = 0;
+    for (size_t i = 0; i < length; ++i)
+        mask |= charBit(s[i]);
+    return mask;
+}
+
+bool isBoundary(const char* name, size_t i)
+{
+    if (i == 0)
+        return true;
+    const char prev = name[i - 1];
+    return prev == '_' || (isUpper(name[i]) && !isUpper(prev));
+}
+
+#ifdef UAISO_QTC_SSE2
+int lowestBit(int bits)
+{
+#  ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, static_cast<unsigned long>(bits));
+    return static_cast<int>(index);
+#  else
+    return __builtin_ctz(static_cast<unsigned>(bits));
+#  endif
+}
+
+int highestBit(int bits)
+{
+#  ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse(&index, static_cast<unsigned long>(bits));
+    return static_cast<int>(index);
+#  else
+    return 31 - __builtin_clz(static_cast<unsigned>(bits));
+#  endif
+}
+#endif
+
+/*!
+ * \brief findFirst
+ *
+ * The first position of \a ch in [from, to) of \a s, \a to if none. Sixteen
+ * characters are compared at a time where SSE2 is available.
+ */
+size_t findFirst(const char* s, size_t from, size_t to, char ch)
+{
+#ifdef UAISO_QTC_SSE2
+    const __m128i needle = _mm_set1_epi8(ch);
+    for (; from + 16 <= to; from += 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + from));
+        const int hits = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (hits)
+            return from + lowestBit(hits);
+    }
+#endif
+    for (; from < to; ++from) {
+        if (s[from] == ch)
+            return from;
+    }
+    return to;
+}
+
+/*!
+ * \brief findLast
+ *
+ * The last position of \a ch in [0, to) of \a s, npos if none.
+ */
+size_t findLast(const char* s, size_t to, char ch)
+{
+#ifdef UAISO_QTC_SSE2
+    const __m128i needle = _mm_set1_epi8(ch);
+    for (; to >= 16; to -= 16) {
+        const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + to - 16));
+        const int hits = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (hits)
+            return to - 16 + highestBit(hits);
+    }
+#endif
+    while (to > 0) {
+        if (s[--to] == ch)
+            return to;
+    }
+    return std::string::npos;
+}
+
+} // anonymous
+
+FuzzyMatcher::FuzzyMatcher()
+{}
+
+void FuzzyMatcher::reserve(size_t count)
+{
+    m_masks.reserve(count);
+    m_offsets.reserve(count);
+    m_lengths.reserve(count);
+    m_bias.reserve(count);
+}
+
+void FuzzyMatcher::add(const std::string& name, int kindRank, int distance)
+{
+    const size_t length = std::min<size_t>(name.size(),
+                                           std::numeric_limits<uint16_t>::max());
+    m_masks.push_back(charMask(name.data(), length));
+    m_offsets.push_back(static_cast<uint32_t>(m_names.size()));
+    m_lengths.push_back(static_cast<uint16_t>(length));
+    m_bias.push_back(static_cast<int16_t>(kindRank * kKindWeight
+                                          - distance * kDistanceWeight));
+    m_names.append(name, 0, length);
+    for (size_t i = 0; i < length; ++i)
+        m_lowerNames.push_back(toLower(name[i]));
+}
+
+bool FuzzyMatcher::score(size_t index,
+                         const std::string& pattern,
+                         const std::string& lowerPattern,
+                         std::vector<size_t>* limits,
+                         int* result) const
+{
+    const char* name = m_names.data() + m_offsets[index];
+    const char* lower = m_lowerNames.data() + m_offsets[index];
+    const size_t length = m_lengths[index];
+    if (pattern.size() > length)
+        return false;
+
+    // From the end, the last position each pattern character may take with
+    // the rest of the pattern still matching after it. That's also the test
+    // of whether the pattern is a subsequence at all.
+    size_t end = length;
+    for (size_t p = lowerPattern.size(); p-- > 0;) {
+        end = findLast(lower, end, lowerPattern[p]);
+        if (end == std::string::npos)
+            return false;
+        (*limits)[p] = end;
+    }
+
+    // Greedy match, preferring a word boundary or a consecutive character
+    // over the next plain occurrence, but never past the limit, so the
+    // first occurrence is the fallback and the match can't get stuck.
+    int score = 0;
+    int gaps = 0;
+    size_t pos = 0;
+    size_t last = std::numeric_limits<size_t>::max();
+    for (size_t p = 0; p < lowerPattern.size(); ++p) {
+        const char ch = lowerPattern[p];
+        const size_t limit = (*limits)[p] + 1;
+        size_t found = findFirst(lower, pos, limit, ch);
+        for (size_t i = found; i < limit; i = findFirst(lower, i + 1, limit, ch)) {
+            if (i == last + 1 || isBoundary(name, i)) {
+                found = i;
+                break;
+            }
+        }
+
+        ++score;
+        if (found == 0)
+            score += kStartBonus;
+        else if (isBoundary(name, found))
+            score += kBoundaryBonus;
+        if (found == last + 1)
+            score += kConsecutiveBonus;
+        if (name[found] == pattern[p])
+            score += kCaseBonus;
+        gaps += static_cast<int>(found - pos);
+
+        last = found;
+        pos = found + 1;
+    }
+
+    score -= std::min(gaps * kGapPenalty, kMaxGapPenalty);
+    if (lowerPattern.compare(0, lowerPattern.size(), lower, lowerPattern.size()) == 0)
+        score += length == lowerPattern.size() ? kExactBonus : kPrefixBonus;
+
+    // Prefer shorter names among otherwise equal matches. Scores may well
+    // be negative, whether there's a match at all is the return value.
+    *result = score * 8 - static_cast<int>(length - pattern.size()) / 4;
+    return true;
+}
+
+std::vector<size_t> FuzzyMatcher::rank(const std::string& pattern, size_t topN) const
+{
+    std::string lowerPattern(pattern);
+    std::transform(lowerPattern.begin(), lowerPattern.end(),
+                   lowerPattern.begin(), toLower);
+    const uint64_t patternMask = charMask(pattern.data(), pattern.size());
+
+    // Character-set prefilter over the mask array, two masks at a time
+    // where SSE2 is available (a 64-bit compare is two 32-bit ones).
+    const size_t count = m_masks.size();
+    std::vector<uint32_t> survivors(count);
+    size_t numSurvivors = 0;
+    size_t i = 0;
+#ifdef UAISO_QTC_SSE2
+    const __m128i wanted = _mm_set1_epi64x(static_cast<long long>(patternMask));
+    for (; i + 2 <= count; i += 2) {
+        const __m128i masks = _mm_loadu_si128(reinterpret_cast<const __m128i*>(&m_masks[i]));
+        const __m128i equal = _mm_cmpeq_epi32(_mm_and_si128(masks, wanted), wanted);
+        const int bits = _mm_movemask_ps(_mm_castsi128_ps(equal));
+        survivors[numSurvivors] = static_cast<uint32_t>(i);
+        numSurvivors += (bits & 3) == 3;
+        survivors[numSurvivors] = static_cast<uint32_t>(i + 1);
+        numSurvivors += (bits >> 2) == 3;
+    }
+#endif
+    for (; i < count; ++i) {
+        survivors[numSurvivors] = static_cast<uint32_t>(i);
+        numSurvivors += (m_masks[i] & patternMask) == patternMask;
+    }
+
+    std::vector<std::pair<int, uint32_t>> scored;
+    scored.reserve(numSurvivors);
+    std::vector<size_t> limits(pattern.size());
+    for (size_t j = 0; j < numSurvivors; ++j) {
+        const uint32_t index = survivors[j];
+        int s;
+        if (score(index, pattern, lowerPattern, &limits, &s))
+            scored.emplace_back(s + m_bias[index], index);
+    }
+
+    auto better = [this](const std::pair<int, uint32_t>& a,
+                         const std::pair<int, uint32_t>& b) {
+        if (a.first != b.first)
+            return a.first > b.first;
+        return m_names.compare(m_offsets[a.second], m_lengths[a.second],
+                               m_names, m_offsets[b.second], m_lengths[b.second]) < 0;
+    };
+    const size_t n = std::min(topN, scored.size());
+    std::partial_sort(scored.begin(), scored.begin() + n, scored.end(), better);
+
+    std::vector<size_t> ranked;
+    ranked.reserve(n);
+    for (size_t i = 0; i < n; ++i)
+        ranked.push_back(scored[i].second);
+    return ranked;
+}
@@ -0,0 +1,89 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_FUZZYMATCHER_H
+#define UAISO_QTC_FUZZYMATCHER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The FuzzyMatcher class
+ *
+ * Ranks completion candidates against a typed pattern. Each candidate keeps
+ * a 64-bit mask of the characters it contains, so most candidates that
+ * can't be a subsequence match are rejected by a mask test over a
+ * contiguous array before any scoring happens. The mask test and the
+ * character scans of scoring use SSE2 where it's available.
+ *
+ * The uaisofuzzybench tool times ranking over synthetic candidates.
+ */
+class FuzzyMatcher
+{
+public:
+    FuzzyMatcher();
+
+    void reserve(size_t count);
+
+    /*!
+     * \brief add
+     *
+     * A higher \a kindRank and a lower \a distance (a ScopeDistance, 0 for
+     * the innermost scope) make a candidate rank higher on equal match.
+     */
+    void add(const std::string& name, int kindRank, int distance);
+
+    size_t size() const { return m_masks.size(); }
+
+    /*!
+     * \brief rank
+     *
+     * Return the indexes of at most \a topN candidates matching \a pattern,
+     * best first. An empty pattern matches every candidate.
+     */
+    std::vector<size_t> rank(const std::string& pattern, size_t topN) const;
+
+private:
+    bool score(size_t index, const std::string& pattern,
+               const std::string& lowerPattern,
+               std::vector<size_t>* limits,
+               int* result) const;
+
+    std::vector<uint64_t> m_masks;
+    std::vector<uint32_t> m_offsets;
+    std::vector<uint16_t> m_lengths;
+    std::vector<int16_t> m_bias;
+    std::string m_names;
+    std::string m_lowerNames;
+};
+
+} // namespace UaisoQtc
+
+#endif
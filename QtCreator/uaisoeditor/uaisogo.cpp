@@ -0,0 +1,457 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisogo.h"
+#include "uaisopipeline.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QRegExp>
+#include <QTextStream>
+#include <QVector>
+
+#include <functional>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+
+namespace {
+
+const int kGoToolTimeout = 10000;
+
+struct Found
+{
+    QString m_import;
+    QString m_dir;
+    QStringList m_files;
+    qint64 m_modified;
+};
+
+bool isSkipped(const QString& dirName)
+{
+    // What the go tool ignores, plus vendor directories, which are only
+    // searched from within their tree.
+    return dirName.startsWith(QLatin1Char('.'))
+            || dirName.startsWith(QLatin1Char('_'))
+            || dirName == QLatin1String("testdata")
+            || dirName == QLatin1String("vendor");
+}
+
+QStringList listPackage(const QDir& dir, QStringList* subdirs)
+{
+    QStringList files;
+    for (const QFileInfo& info : dir.entryInfoList(QDir::Dirs | QDir::Files
+                                                   | QDir::NoDotAndDotDot)) {
+        const QString& name = info.fileName();
+        if (info.isDir()) {
+            if (subdirs && !isSkipped(name))
+                subdirs->append(info.absoluteFilePath());
+        } else if (name.endsWith(QLatin1String(".go"))
+                   && !name.endsWith(QLatin1String("_test.go"))) {
+            files.append(info.absoluteFilePath());
+        }
+    }
+    return files;
+}
+
+qint64 modifiedAt(const QFileInfo& info)
+{
+    return info.lastModified().toMSecsSinceEpoch();
+}
+
+QString unquote(QString text)
+{
+    text.remove(QLatin1Char('"'));
+    text.remove(QLatin1Char('`'));
+    return text;
+}
+
+// Upper-case letters are escaped in module cache paths.
+QString escapeModulePath(const QString& path)
+{
+    QString escaped;
+    escaped.reserve(path.size());
+    for (const QChar c : path) {
+        if (c.isUpper())
+            escaped.append(QLatin1Char('!')).append(c.toLower());
+        else
+            escaped.append(c);
+    }
+    return escaped;
+}
+
+bool hasPrefix(const QString& import, const QString& path)
+{
+    return !path.isEmpty()
+            && import.startsWith(path)
+            && (import.size() == path.size() || import.at(path.size()) == QLatin1Char('/'));
+}
+
+} // anonymous
+
+void UaisoQtc::goEnvironment(QString* goRoot, QStringList* goPath)
+{
+    const QProcessEnvironment& env = QProcessEnvironment::systemEnvironment();
+    *goRoot = env.value(QLatin1String("GOROOT"));
+    QString path = env.value(QLatin1String("GOPATH"));
+
+    QProcess process;
+    process.start(QLatin1String("go"), QStringList() << QLatin1String("env")
+                  << QLatin1String("GOROOT") << QLatin1String("GOPATH"));
+    if (process.waitForFinished(kGoToolTimeout)
+            && process.exitStatus() == QProcess::NormalExit
+            && process.exitCode() == 0) {
+        const QStringList& lines =
+                QString::fromLocal8Bit(process.readAllStandardOutput()).split(QLatin1Char('\n'));
+        if (lines.size() >= 2) {
+            *goRoot = lines.at(0).trimmed();
+            path = lines.at(1).trimmed();
+        }
+    } else {
+        process.kill();
+        process.waitForFinished();
+    }
+
+    if (path.isEmpty())
+        path = QDir::homePath() + QLatin1String("/go");
+    goPath->clear();
+    for (const QString& entry : path.split(QDir::listSeparator(), QString::SkipEmptyParts))
+        goPath->append(QDir::cleanPath(entry));
+}
+
+GoPackageIndex::GoPackageIndex()
+{}
+
+int GoPackageIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_dirsByImport.size();
+}
+
+void GoPackageIndex::build(const QStringList& searchPaths, const CancellationToken& token)
+{
+    QString goRoot;
+    QStringList goPath;
+    goEnvironment(&goRoot, &goPath);
+
+    // The order of roots is the order in which they're searched.
+    QStringList roots;
+    if (!goRoot.isEmpty())
+        roots.append(QDir::cleanPath(goRoot + QLatin1String("/src")));
+    for (const QString& entry : goPath)
+        roots.append(entry + QLatin1String("/src"));
+    for (const QString& path : searchPaths)
+        roots.append(QDir::cleanPath(path));
+    roots.removeDuplicates();
+    for (int i = roots.size() - 1; i >= 0; --i) {
+        if (!QFileInfo(roots.at(i)).isDir())
+            roots.removeAt(i);
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_roots = roots;
+        m_modCache = goPath.isEmpty() ? QString() : goPath.first() + QLatin1String("/pkg/mod");
+        m_moduleRoots.clear();
+    }
+
+    // Each top-level directory of a root is walked on its own.
+    QVector<QPair<QString, QString>> tops;
+    for (const QString& root : roots) {
+        QStringList subdirs;
+        listPackage(QDir(root), &subdirs);
+        for (const QString& subdir : subdirs)
+            tops.append(qMakePair(root, subdir));
+    }
+
+    std::function<QVector<Found> (const QPair<QString, QString>&)> walk =
+            [&token](const QPair<QString, QString>& top) {
+        QVector<Found> found;
+        QStringList pending(top.second);
+        while (!pending.isEmpty() && !token.isCanceled()) {
+            const QString dir = pending.takeLast();
+            Found pkg;
+            pkg.m_files = listPackage(QDir(dir), &pending);
+            if (pkg.m_files.isEmpty())
+                continue;
+            pkg.m_dir = dir;
+            pkg.m_import = dir.mid(top.first.size() + 1);
+            pkg.m_modified = modifiedAt(QFileInfo(dir));
+            found.append(pkg);
+        }
+        return found;
+    };
+    // Building runs in the global pool, walks go to the index's own.
+    const QVector<QVector<Found>>& walked = mapOn<QVector<Found>>(&m_pool, tops, walk);
+    if (token.isCanceled())
+        return;
+
+    QHash<QString, QString> dirsByImport;
+    QHash<QString, Package> packages;
+    for (const QVector<Found>& found : walked) {
+        for (const Found& pkg : found) {
+            if (!dirsByImport.contains(pkg.m_import))
+                dirsByImport.insert(pkg.m_import, pkg.m_dir);
+            Package& entry = packages[pkg.m_dir];
+            entry.m_modified = pkg.m_modified;
+            entry.m_files = pkg.m_files;
+        }
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_dirsByImport.swap(dirsByImport);
+    for (auto it = packages.constBegin(); it != packages.constEnd(); ++it)
+        m_packages.insert(it.key(), it.value());
+}
+
+QStringList GoPackageIndex::resolve(const QString& import, const QString& importer)
+{
+    const QString& path = unquote(import);
+    if (path.isEmpty())
+        return QStringList();
+
+    QStringList files;
+    const QString& dir = importer.isEmpty() ? QString() : QFileInfo(importer).absolutePath();
+    if (path.startsWith(QLatin1String("./")) || path.startsWith(QLatin1String("../"))) {
+        if (!dir.isEmpty())
+            package(QDir::cleanPath(dir + QLatin1Char('/') + path), &files);
+        return files;
+    }
+
+    if (!dir.isEmpty()) {
+        // Vendor directories, innermost first, up to the module's root.
+        const std::shared_ptr<const Module>& module = moduleOf(dir);
+        for (QString current = dir; ; ) {
+            if (package(current + QLatin1String("/vendor/") + path, &files))
+                return files;
+            if (module && current == module->m_root)
+                break;
+            const QString& parent = QFileInfo(current).path();
+            if (parent == current)
+                break;
+            current = parent;
+        }
+
+        if (module) {
+            const QString& moduleDir = this->moduleDir(*module, path);
+            if (!moduleDir.isEmpty() && package(moduleDir, &files))
+                return files;
+        }
+    }
+
+    QString known;
+    QStringList roots;
+    {
+        QMutexLocker locker(&m_mutex);
+        known = m_dirsByImport.value(path);
+        roots = m_roots;
+    }
+    if (!known.isEmpty() && package(known, &files))
+        return files;
+
+    // Not there when the roots were scanned, or not yet scanned.
+    for (const QString& root : roots) {
+        if (package(root + QLatin1Char('/') + path, &files))
+            return files;
+    }
+
+    return QStringList();
+}
+
+bool GoPackageIndex::package(const QString& dir, QStringList* files)
+{
+    // A directory's modification time changes when files are added to or
+    // removed from it, which is what matters here.
+    const QFileInfo info(dir);
+    if (!info.isDir())
+        return false;
+    const qint64 modified = modifiedAt(info);
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = m_packages.constFind(dir);
+        if (it != m_packages.constEnd() && it->m_modified == modified) {
+            *files = it->m_files;
+            return !files->isEmpty();
+        }
+    }
+
+    Package pkg;
+    pkg.m_modified = modified;
+    pkg.m_files = listPackage(QDir(dir), nullptr);
+    {
+        QMutexLocker locker(&m_mutex);
+        m_packages.insert(dir, pkg);
+    }
+    *files = pkg.m_files;
+    return !files->isEmpty();
+}
+
+std::shared_ptr<const GoPackageIndex::Module> GoPackageIndex::moduleOf(const QString& dir)
+{
+    QString root;
+    QStringList visited;
+    for (QString current = dir; ; ) {
+        {
+            QMutexLocker locker(&m_mutex);
+            auto it = m_moduleRoots.constFind(current);
+            if (it != m_moduleRoots.constEnd()) {
+                root = *it;
+                break;
+            }
+        }
+        visited.append(current);
+        if (QFileInfo(current + QLatin1String("/go.mod")).isFile()) {
+            root = current;
+            break;
+        }
+        const QString& parent = QFileInfo(current).path();
+        if (parent == current)
+            break;
+        current = parent;
+    }
+
+    {
+        QMutexLocker locker(&m_mutex);
+        for (const QString& current : visited)
+            m_moduleRoots.insert(current, root);
+    }
+    if (root.isEmpty())
+        return std::shared_ptr<const Module>();
+
+    const QFileInfo info(root + QLatin1String("/go.mod"));
+    const qint64 modified = modifiedAt(info);
+    {
+        QMutexLocker locker(&m_mutex);
+        const std::shared_ptr<const Module>& module = m_modules.value(root);
+        if (module && module->m_modified == modified)
+            return module;
+    }
+
+    auto module = std::make_shared<Module>();
+    module->m_modified = modified;
+    module->m_root = root;
+    QFile file(info.absoluteFilePath());
+    if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        QHash<QString, QString> replacedVersions;
+        QString block;
+        auto directive = [&](const QString& kind, const QString& text) {
+            const QStringList& words = text.split(QRegExp(QLatin1String("\\s+")),
+                                                  QString::SkipEmptyParts);
+            if (words.isEmpty())
+                return;
+            if (kind == QLatin1String("module")) {
+                module->m_path = unquote(words.first());
+            } else if (kind == QLatin1String("require") && words.size() >= 2) {
+                const QString& path = unquote(words.at(0));
+                module->m_versions.insert(path, path + QLatin1Char('@') + words.at(1));
+            } else if (kind == QLatin1String("replace")) {
+                const int arrow = words.indexOf(QLatin1String("=>"));
+                if (arrow <= 0 || arrow + 1 >= words.size())
+                    return;
+                const QString& path = unquote(words.first());
+                const QString& target = unquote(words.at(arrow + 1));
+                if (arrow + 2 < words.size()) {
+                    replacedVersions.insert(path, target + QLatin1Char('@') + words.at(arrow + 2));
+                } else if (QDir::isRelativePath(target)) {
+                    module->m_replaces.insert(path,
+                            QDir::cleanPath(root + QLatin1Char('/') + target));
+                } else {
+                    module->m_replaces.insert(path, QDir::cleanPath(target));
+                }
+            }
+        };
+
+        QTextStream in(&file);
+        while (!in.atEnd()) {
+            QString line = in.readLine();
+            const int comment = line.indexOf(QLatin1String("//"));
+            if (comment >= 0)
+                line.truncate(comment);
+            line = line.trimmed();
+            if (line.isEmpty())
+                continue;
+            if (!block.isEmpty()) {
+                if (line == QLatin1String(")"))
+                    block.clear();
+                else
+                    directive(block, line);
+                continue;
+            }
+            const int space = line.indexOf(QLatin1Char(' '));
+            if (space < 0)
+                continue;
+            const QString& kind = line.left(space);
+            const QString& text = line.mid(space + 1).trimmed();
+            if (text == QLatin1String("("))
+                block = kind;
+            else
+                directive(kind, text);
+        }
+
+        // Replacements win, wherever they appear.
+        for (auto it = replacedVersions.constBegin(); it != replacedVersions.constEnd(); ++it)
+            module->m_versions.insert(it.key(), it.value());
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_modules.insert(root, module);
+    return module;
+}
+
+QString GoPackageIndex::moduleDir(const Module& module, const QString& import) const
+{
+    if (hasPrefix(import, module.m_path))
+        return module.m_root + import.mid(module.m_path.size());
+
+    // The longest module path the import is within.
+    QString best;
+    for (auto it = module.m_versions.constBegin(); it != module.m_versions.constEnd(); ++it) {
+        if (it.key().size() > best.size() && hasPrefix(import, it.key()))
+            best = it.key();
+    }
+    for (auto it = module.m_replaces.constBegin(); it != module.m_replaces.constEnd(); ++it) {
+        if (it.key().size() > best.size() && hasPrefix(import, it.key()))
+            best = it.key();
+    }
+    if (best.isEmpty())
+        return QString();
+
+    const QString& rest = import.mid(best.size());
+    auto replace = module.m_replaces.constFind(best);
+    if (replace != module.m_replaces.constEnd())
+        return *replace + rest;
+
+    QMutexLocker locker(&m_mutex);
+    if (m_modCache.isEmpty())
+        return QString();
+    return m_modCache + QLatin1Char('/') + escapeModulePath(module.m_versions.value(best)) + rest;
+}
@@ -0,0 +1,119 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_GO_H
+#define UAISO_QTC_GO_H
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <memory>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+class CancellationToken;
+
+/*!
+ * \brief goEnvironment
+ *
+ * GOROOT and GOPATH (which may have many entries) as the go tool sees
+ * them, falling back to the environment. Blocking.
+ */
+void goEnvironment(QString* goRoot, QStringList* goPath);
+
+/*!
+ * \brief The GoPackageIndex class
+ *
+ * Where Go import paths lead to: a package's directory and its source files
+ * (tests excluded). Imports are resolved the way the go tool does, vendor
+ * directories first, then the importer's module (go.mod, with its require
+ * and replace directives, against the module cache) and finally GOROOT and
+ * GOPATH. Those last are scanned upfront, everything else is looked up on
+ * demand and remembered. A package whose directory changed is listed again,
+ * so is a go.mod, but a new go.mod is only seen after the next build.
+ */
+class GoPackageIndex
+{
+public:
+    GoPackageIndex();
+
+    /*!
+     * \brief build
+     *
+     * Scan GOROOT, GOPATH and \a searchPaths, in parallel. Blocking, and
+     * meant for a background thread. Resolution works meanwhile, though
+     * at the expense of a few more lookups on disk.
+     */
+    void build(const QStringList& searchPaths, const CancellationToken& token);
+
+    /*!
+     * \brief resolve
+     *
+     * Files of the package \a import refers to in \a importer, empty if it
+     * isn't found. Thread-safe.
+     */
+    QStringList resolve(const QString& import, const QString& importer);
+
+    int size() const;
+
+private:
+    struct Package
+    {
+        qint64 m_modified { 0 };
+        QStringList m_files;
+    };
+
+    struct Module
+    {
+        qint64 m_modified { 0 };
+        QString m_root;
+        QString m_path;
+        QHash<QString, QString> m_versions; // Path to path@version in the module cache.
+        QHash<QString, QString> m_replaces; // Path to local directory.
+    };
+
+    bool package(const QString& dir, QStringList* files);
+    std::shared_ptr<const Module> moduleOf(const QString& dir);
+    QString moduleDir(const Module& module, const QString& import) const;
+
+    mutable QMutex m_mutex;
+    QStringList m_roots;
+    QString m_modCache;
+    QHash<QString, QString> m_dirsByImport;
+    QHash<QString, Package> m_packages;
+    QHash<QString, QString> m_moduleRoots; // Directory to its module's root, if any.
+    QHash<QString, std::shared_ptr<const Module>> m_modules;
+    QThreadPool m_pool;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -0,0 +1,497 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisoindex.h"
+#include "uaisoeditor.h"
+#include "uaisomappedfile.h"
+
+#include <QMutexLocker>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Semantic/Snapshot.h>
+#include <Semantic/Symbol.h>
+
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+using namespace UaisoQtc;
+
+namespace {
+
+bool isWordStart(const std::string& name, size_t i)
+{
+    if (i == 0)
+        return true;
+    const char prev = name[i - 1];
+    const char cur = name[i];
+    if (cur == '_')
+        return false;
+    return prev == '_' || (std::isupper(cur) && !std::isupper(prev));
+}
+
+std::string toLower(const std::string& s)
+{
+    std::string lower(s);
+    std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+    return lower;
+}
+
+} // anonymous
+
+    //--------------------//
+    //--- Symbol Index ---//
+    //--------------------//
+
+SymbolIndex::SymbolIndex()
+    : m_data(new Data)
+{}
+
+std::shared_ptr<const SymbolIndex::Bucket> SymbolIndex::buildBucket(
+        const QString& fileName, const QVector<DeclEntry>& decls)
+{
+    std::shared_ptr<Bucket> bucket(new Bucket);
+    bucket->m_fileName = fileName;
+    bucket->m_entries.reserve(decls.size());
+    for (const DeclEntry& decl : decls) {
+        Entry entry;
+        entry.m_name = decl.m_name.toStdString();
+        if (entry.m_name.empty())
+            continue;
+        entry.m_lower = toLower(entry.m_name);
+        entry.m_line = decl.m_line;
+        entry.m_col = decl.m_col;
+        entry.m_kind = decl.m_kind;
+
+        const uint32_t id = static_cast<uint32_t>(bucket->m_entries.size());
+        for (size_t i = 0; i < entry.m_name.size(); ++i) {
+            if (isWordStart(entry.m_name, i))
+                bucket->m_keys.push_back(Key { id, static_cast<uint32_t>(i) });
+        }
+        bucket->m_entries.push_back(std::move(entry));
+    }
+
+    const std::vector<Entry>& entries = bucket->m_entries;
+    std::sort(bucket->m_keys.begin(), bucket->m_keys.end(),
+              [&entries](const Key& a, const Key& b) {
+        return entries[a.m_entry].m_lower.compare(a.m_start, std::string::npos,
+                                                  entries[b.m_entry].m_lower,
+                                                  b.m_start, std::string::npos) < 0;
+    });
+    return bucket;
+}
+
+void SymbolIndex::publish(const QString& fileName, const std::shared_ptr<const Bucket>& bucket)
+{
+    QMutexLocker locker(&m_writeLock);
+
+    std::shared_ptr<Data> next(new Data(*std::atomic_load(&m_data)));
+    if (const std::shared_ptr<const Bucket>* current = next->m_buckets.find(fileName))
+        next->m_size -= (*current)->m_entries.size();
+    if (bucket) {
+        next->m_size += bucket->m_entries.size();
+        next->m_buckets.insert(fileName, bucket);
+    } else {
+        next->m_buckets.remove(fileName);
+    }
+    std::atomic_store(&m_data, std::shared_ptr<const Data>(std::move(next)));
+}
+
+void SymbolIndex::update(const QString& fileName, const QVector<DeclEntry>& decls)
+{
+    publish(fileName, buildBucket(fileName, decls));
+}
+
+void SymbolIndex::remove(const QString& fileName)
+{
+    publish(fileName, std::shared_ptr<const Bucket>());
+}
+
+std::vector<SymbolLocation> SymbolIndex::find(const QString& prefix, size_t max) const
+{
+    const std::string key = toLower(prefix.toStdString());
+
+    // The version is pinned, buckets stay while matches point into them.
+    const std::shared_ptr<const Data> data = std::atomic_load(&m_data);
+
+    // Each bucket's first matches, in key order, compete for the result.
+    typedef std::pair<const Bucket*, Key> Match;
+    std::vector<Match> matches;
+    data->m_buckets.forEach([&](const QString&, const std::shared_ptr<const Bucket>& bucket) {
+        const std::vector<Entry>& entries = bucket->m_entries;
+        auto it = std::lower_bound(bucket->m_keys.begin(), bucket->m_keys.end(), key,
+                                   [&entries](const Key& a, const std::string& k) {
+            return entries[a.m_entry].m_lower.compare(a.m_start, std::string::npos, k) < 0;
+        });
+
+        std::unordered_set<uint32_t> seen;
+        for (; it != bucket->m_keys.end() && seen.size() < max; ++it) {
+            if (entries[it->m_entry].m_lower.compare(it->m_start, key.size(), key) != 0)
+                break;
+            if (seen.insert(it->m_entry).second)
+                matches.push_back(Match(bucket.get(), *it));
+        }
+    });
+
+    const size_t count = std::min(max, matches.size());
+    std::partial_sort(matches.begin(), matches.begin() + count, matches.end(),
+                      [](const Match& a, const Match& b) {
+        const Entry& x = a.first->m_entries[a.second.m_entry];
+        const Entry& y = b.first->m_entries[b.second.m_entry];
+        return x.m_lower.compare(a.second.m_start, std::string::npos,
+                                 y.m_lower, b.second.m_start, std::string::npos) < 0;
+    });
+
+    std::vector<SymbolLocation> found;
+    found.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        const Entry& entry = matches[i].first->m_entries[matches[i].second.m_entry];
+        SymbolLocation loc;
+        loc.m_name = QString::fromStdString(entry.m_name);
+        loc.m_fileName = matches[i].first->m_fileName;
+        loc.m_line = entry.m_line;
+        loc.m_col = entry.m_col;
+        loc.m_kind = entry.m_kind;
+        found.push_back(loc);
+    }
+    return found;
+}
+
+size_t SymbolIndex::size() const
+{
+    return std::atomic_load(&m_data)->m_size;
+}
+
+    //-------------------//
+    //--- Usage Index ---//
+    //-------------------//
+
+UsageIndex::UsageIndex()
+    : m_data(new Data)
+{}
+
+UsageIndex::View UsageIndex::view() const
+{
+    return View(std::atomic_load(&m_data));
+}
+
+void UsageIndex::publish(const QString& fileName, const FileUsages* usages)
+{
+    QMutexLocker locker(&m_writeLock);
+
+    // Shards are shared, only the file's one is copied.
+    std::shared_ptr<Data> next(new Data(*std::atomic_load(&m_data)));
+    if (usages)
+        next->insert(fileName, *usages);
+    else
+        next->remove(fileName);
+    std::atomic_store(&m_data, std::shared_ptr<const Data>(std::move(next)));
+}
+
+void UsageIndex::update(const QString& fileName, QVector<SymbolRef> refs)
+{
+    std::sort(refs.begin(), refs.end(), [](const SymbolRef& a, const SymbolRef& b) {
+        return a.m_line != b.m_line ? a.m_line < b.m_line : a.m_col < b.m_col;
+    });
+
+    FileUsages usages;
+    usages.m_refs = refs;
+    for (const SymbolRef& ref : refs)
+        usages.m_keys.insert(ref.m_key);
+    publish(fileName, &usages);
+}
+
+void UsageIndex::remove(const QString& fileName)
+{
+    publish(fileName, nullptr);
+}
+
+bool UsageIndex::View::symbolAt(const QString& fileName, int line, int col, SymbolKey* key) const
+{
+    const FileUsages* usages = m_data->find(fileName);
+    if (!usages)
+        return false;
+
+    // Last reference starting at or before the position.
+    const QVector<SymbolRef>& refs = usages->m_refs;
+    auto ref = std::upper_bound(refs.begin(), refs.end(), qMakePair(line, col),
+                                [](const QPair<int, int>& pos, const SymbolRef& r) {
+        return pos.first != r.m_line ? pos.first < r.m_line : pos.second < r.m_col;
+    });
+    if (ref == refs.begin())
+        return false;
+    --ref;
+    if (ref->m_line != line || col > ref->m_col + ref->m_length)
+        return false;
+
+    *key = ref->m_key;
+    return true;
+}
+
+QVector<QPair<QString, SymbolRef>> UsageIndex::View::usages(const SymbolKey& key) const
+{
+    QVector<QPair<QString, SymbolRef>> found;
+    m_data->forEach([&](const QString& fileName, const FileUsages& usages) {
+        if (!usages.m_keys.contains(key))
+            return;
+        for (const SymbolRef& ref : usages.m_refs) {
+            if (ref.m_key == key)
+                found.append(qMakePair(fileName, ref));
+        }
+    });
+    return found;
+}
+
+    //-------------------------//
+    //--- Declaration Index ---//
+    //-------------------------//
+
+DeclIndex::DeclIndex()
+    : m_tables(new Tables)
+{}
+
+DeclIndex::DeclTable DeclIndex::buildTable(const QString& fileName,
+                                           const QVector<DeclEntry>& decls)
+{
+    DeclTable table;
+    table.m_decls = decls;
+    for (const DeclEntry& decl : decls) {
+        SymbolKey key;
+        key.m_fileName = intern(fileName);
+        key.m_name = decl.m_name;
+        key.m_kind = decl.m_kind;
+        key.m_line = decl.m_line;
+        key.m_col = decl.m_col;
+        table.m_keys.insert(decl.m_name, key);
+    }
+    return table;
+}
+
+void DeclIndex::publish(const QString& fileName, const DeclTable* table)
+{
+    QMutexLocker locker(&m_writeLock);
+
+    // Shards are shared, only the file's one is copied.
+    std::shared_ptr<Tables> next(new Tables(*std::atomic_load(&m_tables)));
+    if (table)
+        next->insert(fileName, *table);
+    else
+        next->remove(fileName);
+    std::atomic_store(&m_tables, std::shared_ptr<const Tables>(std::move(next)));
+}
+
+void DeclIndex::update(const QString& fileName, const QVector<DeclEntry>& decls)
+{
+    const DeclTable& table = buildTable(fileName, decls);
+    publish(fileName, &table);
+}
+
+void DeclIndex::remove(const QString& fileName)
+{
+    publish(fileName, nullptr);
+}
+
+bool DeclIndex::find(const QString& fileName, const QString& name, SymbolKey* key)
+{
+    const std::shared_ptr<const Tables> tables = std::atomic_load(&m_tables);
+    if (const DeclTable* table = tables->find(fileName)) {
+        auto decl = table->m_keys.constFind(name);
+        if (decl == table->m_keys.constEnd())
+            return false;
+        *key = *decl;
+        return true;
+    }
+
+    const uaiso::Program* prog =
+            UaisoEditorPlugin::instance()->snapshot().find(fileName.toStdString());
+    if (!prog)
+        return false;
+
+    const DeclTable& built = buildTable(fileName, declEntries(prog));
+    publish(fileName, &built);
+
+    auto decl = built.m_keys.constFind(name);
+    if (decl == built.m_keys.constEnd())
+        return false;
+    *key = *decl;
+    return true;
+}
+
+bool DeclIndex::lookup(const QString& fileName, const QString& name, SymbolKey* key) const
+{
+    const std::shared_ptr<const Tables> tables = std::atomic_load(&m_tables);
+    const DeclTable* table = tables->find(fileName);
+    if (!table)
+        return false;
+    auto decl = table->m_keys.constFind(name);
+    if (decl == table->m_keys.constEnd())
+        return false;
+    *key = *decl;
+    return true;
+}
+
+QVector<DeclEntry> DeclIndex::decls(const QString& fileName) const
+{
+    const std::shared_ptr<const Tables> tables = std::atomic_load(&m_tables);
+    return tables->value(fileName).m_decls;
+}
+
+    //-----------------------//
+    //--- Signature Index ---//
+    //-----------------------//
+
+SignatureIndex::SignatureIndex()
+    : m_tables(new Tables)
+{}
+
+SignatureIndex::SignatureTable SignatureIndex::buildTable(const QVector<DeclEntry>& decls,
+                                                          const QStringList& lines)
+{
+    QVector<DeclEntry> sorted = decls;
+    std::sort(sorted.begin(), sorted.end(), [](const DeclEntry& a, const DeclEntry& b) {
+        return a.m_line < b.m_line;
+    });
+
+    SignatureTable table;
+    for (int i = 0; i < sorted.size(); ++i) {
+        const DeclEntry& decl = sorted.at(i);
+        if (decl.m_line < 0 || decl.m_line >= lines.size())
+            continue;
+        const QString& header = lines.at(decl.m_line);
+        switch (static_cast<uaiso::Symbol::Kind>(decl.m_kind)) {
+        case uaiso::Symbol::Kind::Func: {
+            // The engine's columns are in bytes.
+            const int col = charColumn(header.toStdString(), decl.m_col);
+            const QString& signature = declarationHeader(lines, decl.m_line, col);
+            if (signature.isEmpty())
+                break;
+            table.m_signatures.insert(ScopedName(QString(), decl.m_name), signature);
+            // A receiver before the name (Go) makes it a method as well.
+            if (header.left(col).contains(QLatin1Char(')')) && !table.m_methods.contains(decl.m_name))
+                table.m_methods.insert(decl.m_name, signature);
+            break;
+        }
+        case uaiso::Symbol::Kind::Record: {
+            // Members go up to the next declaration.
+            const int end = i + 1 < sorted.size() ? sorted.at(i + 1).m_line : lines.size();
+            for (const MemberEntry& member : recordMembers(lines, decl.m_line, end)) {
+                if (member.m_name.isEmpty())
+                    continue;
+                table.m_signatures.insert(ScopedName(decl.m_name, member.m_name), member.m_header);
+                if (!table.m_methods.contains(member.m_name))
+                    table.m_methods.insert(member.m_name, member.m_header);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+    }
+    return table;
+}
+
+void SignatureIndex::publish(const QString& fileName, const SignatureTable* table)
+{
+    QMutexLocker locker(&m_writeLock);
+
+    std::shared_ptr<Tables> next(new Tables(*std::atomic_load(&m_tables)));
+    if (table)
+        next->insert(fileName, *table);
+    else
+        next->remove(fileName);
+    std::atomic_store(&m_tables, std::shared_ptr<const Tables>(std::move(next)));
+}
+
+void SignatureIndex::update(const QString& fileName,
+                            const QVector<DeclEntry>& decls,
+                            const QStringList& lines)
+{
+    const SignatureTable& table = buildTable(decls, lines);
+    publish(fileName, &table);
+}
+
+void SignatureIndex::remove(const QString& fileName)
+{
+    publish(fileName, nullptr);
+}
+
+const SignatureIndex::SignatureTable* SignatureIndex::table(const QString& fileName,
+                                                            std::shared_ptr<const Tables>* tables,
+                                                            SignatureTable* built)
+{
+    *tables = std::atomic_load(&m_tables);
+    if (const SignatureTable* table = (*tables)->find(fileName))
+        return table;
+
+    // The declarations are those the loader indexed, not the snapshot's,
+    // which can't be read off the GUI thread.
+    const QVector<DeclEntry>& decls = UaisoEditorPlugin::instance()->declIndex()->decls(fileName);
+    if (decls.isEmpty())
+        return nullptr;
+
+    MappedFile file(fileName);
+    if (!file.isValid())
+        return nullptr;
+    const QStringList& lines =
+            QString::fromUtf8(file.data(), static_cast<int>(file.size())).split(QLatin1Char('\n'));
+    *built = buildTable(decls, lines);
+    publish(fileName, built);
+    return built;
+}
+
+bool SignatureIndex::find(const SymbolKey& key, QString* signature)
+{
+    std::shared_ptr<const Tables> tables;
+    SignatureTable built;
+    const SignatureTable* table = this->table(key.m_fileName, &tables, &built);
+    if (!table)
+        return false;
+
+    auto found = table->m_signatures.constFind(ScopedName(key.m_scope, key.m_name));
+    if (found == table->m_signatures.constEnd())
+        return false;
+    *signature = *found;
+    return true;
+}
+
+bool SignatureIndex::findMethod(const QStringList& fileNames,
+                                const QString& name,
+                                QString* signature)
+{
+    for (const QString& fileName : fileNames) {
+        std::shared_ptr<const Tables> tables;
+        SignatureTable built;
+        const SignatureTable* table = this->table(fileName, &tables, &built);
+        if (!table)
+            continue;
+        auto found = table->m_methods.constFind(name);
+        if (found != table->m_methods.constEnd()) {
+            *signature = *found;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,382 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_INDEX_H
+#define UAISO_QTC_INDEX_H
+
+#include "uaisopipeline.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+    //--------------------//
+    //--- Sharded Hash ---//
+    //--------------------//
+
+/*!
+ * \brief The ShardedHash class
+ *
+ * A hash split in shards which are never modified once built. A copy shares
+ * every shard, changing it copies only the shard of the key, so a version
+ * of an index can be made out of the previous one without copying it.
+ */
+template <class Key, class Value>
+class ShardedHash
+{
+public:
+    ShardedHash()
+    {
+        for (auto& shard : m_shards)
+            shard.reset(new Shard);
+    }
+
+    const Value* find(const Key& key) const
+    {
+        const Shard& shard = *m_shards[index(key)];
+        auto it = shard.constFind(key);
+        return it == shard.constEnd() ? nullptr : &*it;
+    }
+
+    Value value(const Key& key) const
+    {
+        const Value* found = find(key);
+        return found ? *found : Value();
+    }
+
+    void insert(const Key& key, const Value& value)
+    {
+        std::shared_ptr<const Shard>& slot = m_shards[index(key)];
+        std::shared_ptr<Shard> shard(new Shard(*slot));
+        shard->insert(key, value);
+        slot = std::move(shard);
+    }
+
+    void remove(const Key& key)
+    {
+        std::shared_ptr<const Shard>& slot = m_shards[index(key)];
+        if (!slot->contains(key))
+            return;
+        std::shared_ptr<Shard> shard(new Shard(*slot));
+        shard->remove(key);
+        slot = std::move(shard);
+    }
+
+    template <class Func>
+    void forEach(Func func) const
+    {
+        for (const auto& shard : m_shards) {
+            for (auto it = shard->constBegin(); it != shard->constEnd(); ++it)
+                func(it.key(), it.value());
+        }
+    }
+
+private:
+    typedef QHash<Key, Value> Shard;
+    static const int kShards = 64;
+
+    static int index(const Key& key) { return qHash(key) % kShards; }
+
+    std::array<std::shared_ptr<const Shard>, kShards> m_shards;
+};
+
+    //--------------------//
+    //--- Symbol Index ---//
+    //--------------------//
+
+struct SymbolLocation
+{
+    QString m_name;
+    QString m_fileName;
+    int m_line;
+    int m_col;
+    int m_kind;
+};
+
+/*!
+ * \brief The SymbolIndex class
+ *
+ * Declaration names of every program in the snapshot. Each file has a
+ * bucket of its own, with the file's lower-cased keys sorted for prefix
+ * lookup, so an update only rebuilds the file's bucket. Besides the whole
+ * name, each word of a name (after an underscore or a case change) is a
+ * key too, so "handler" finds "RequestHandler".
+ *
+ * Versioned like UsageIndex: lookups don't lock.
+ */
+class SymbolIndex
+{
+public:
+    SymbolIndex();
+
+    void update(const QString& fileName, const QVector<DeclEntry>& decls);
+    void remove(const QString& fileName);
+
+    std::vector<SymbolLocation> find(const QString& prefix, size_t max) const;
+
+    size_t size() const;
+
+private:
+    // A key is the suffix of an entry's lower-cased name starting at a word.
+    struct Key
+    {
+        uint32_t m_entry;
+        uint32_t m_start;
+    };
+
+    struct Entry
+    {
+        std::string m_name;
+        std::string m_lower;
+        int m_line;
+        int m_col;
+        int m_kind;
+    };
+
+    struct Bucket
+    {
+        QString m_fileName;
+        std::vector<Entry> m_entries;
+        std::vector<Key> m_keys;
+    };
+
+    struct Data
+    {
+        ShardedHash<QString, std::shared_ptr<const Bucket>> m_buckets;
+        size_t m_size { 0 };
+    };
+
+    static std::shared_ptr<const Bucket> buildBucket(const QString& fileName,
+                                                     const QVector<DeclEntry>& decls);
+    void publish(const QString& fileName, const std::shared_ptr<const Bucket>& bucket);
+
+    QMutex m_writeLock;
+    std::shared_ptr<const Data> m_data;
+};
+
+    //-------------------//
+    //--- Usage Index ---//
+    //-------------------//
+
+/*!
+ * \brief The UsageIndex class
+ *
+ * Inverted index from a symbol to the files referencing it, with each
+ * file's references kept sorted by position. Replaced per file on every
+ * semantic pass.
+ *
+ * Versions are immutable. An update builds the next one out of the
+ * current, sharing every shard but the one of the file it touches, and
+ * publishes it by swapping a pointer. Readers pin a version and never wait
+ * on a writer, a version goes away along with its last reader.
+ *
+ * Looking for usages goes over the files, each knows which symbols it
+ * references, and only the references of those which have it are scanned.
+ */
+class UsageIndex
+{
+    struct FileUsages
+    {
+        QVector<SymbolRef> m_refs;
+        QSet<SymbolKey> m_keys;
+    };
+
+    typedef ShardedHash<QString, FileUsages> Data;
+
+public:
+    /*!
+     * \brief The View class
+     *
+     * A pinned version, answers stay consistent among each other.
+     */
+    class View
+    {
+    public:
+        bool symbolAt(const QString& fileName, int line, int col, SymbolKey* key) const;
+
+        QVector<QPair<QString, SymbolRef>> usages(const SymbolKey& key) const;
+
+    private:
+        friend class UsageIndex;
+        explicit View(const std::shared_ptr<const Data>& data) : m_data(data) {}
+
+        std::shared_ptr<const Data> m_data;
+    };
+
+    UsageIndex();
+
+    View view() const;
+
+    void update(const QString& fileName, QVector<SymbolRef> refs);
+    void remove(const QString& fileName);
+
+    bool symbolAt(const QString& fileName, int line, int col, SymbolKey* key) const
+    {
+        return view().symbolAt(fileName, line, col, key);
+    }
+
+    QVector<QPair<QString, SymbolRef>> usages(const SymbolKey& key) const
+    {
+        return view().usages(key);
+    }
+
+private:
+    void publish(const QString& fileName, const FileUsages* usages);
+
+    QMutex m_writeLock;
+    std::shared_ptr<const Data> m_data;
+};
+
+    //-------------------------//
+    //--- Declaration Index ---//
+    //-------------------------//
+
+/*!
+ * \brief The DeclIndex class
+ *
+ * Per-file table from a top-level declaration's name to its key, filled as
+ * programs are bound or loaded. Programs that reached the snapshot some
+ * other way get their table built on first lookup.
+ *
+ * Versioned like UsageIndex: lookups don't lock.
+ */
+class DeclIndex
+{
+public:
+    DeclIndex();
+
+    void update(const QString& fileName, const QVector<DeclEntry>& decls);
+    void remove(const QString& fileName);
+
+    bool find(const QString& fileName, const QString& name, SymbolKey* key);
+
+    /*!
+     * \brief lookup
+     *
+     * Like find, but only in tables already there, nothing is built from
+     * the snapshot. It may be called from any thread.
+     */
+    bool lookup(const QString& fileName, const QString& name, SymbolKey* key) const;
+
+    /*!
+     * \brief decls
+     *
+     * The file's declarations as last updated, nothing is built. It may be
+     * called from any thread, it's the plugin's DeclLookup.
+     */
+    QVector<DeclEntry> decls(const QString& fileName) const;
+
+private:
+    struct DeclTable
+    {
+        QVector<DeclEntry> m_decls;
+        QHash<QString, SymbolKey> m_keys;
+    };
+
+    typedef ShardedHash<QString, DeclTable> Tables;
+
+    static DeclTable buildTable(const QString& fileName, const QVector<DeclEntry>& decls);
+    void publish(const QString& fileName, const DeclTable* table);
+
+    QMutex m_writeLock;
+    std::shared_ptr<const Tables> m_tables;
+};
+
+    //-----------------------//
+    //--- Signature Index ---//
+    //-----------------------//
+
+/*!
+ * \brief The SignatureIndex class
+ *
+ * A function's signature, as written, by the function's scope and name,
+ * the same as in its SymbolKey. It's taken from the source as the file is
+ * bound, files that reached the snapshot some other way are read on first
+ * lookup (with the declarations DeclIndex has for them).
+ *
+ * Methods are found in the text of a record's body, the engine only lists
+ * top-level declarations. They're also kept by name alone, for calls whose
+ * receiver isn't resolved.
+ *
+ * Versioned like UsageIndex: lookups don't lock, and may be made from any
+ * thread.
+ */
+class SignatureIndex
+{
+public:
+    SignatureIndex();
+
+    void update(const QString& fileName,
+                const QVector<DeclEntry>& decls,
+                const QStringList& lines);
+    void remove(const QString& fileName);
+
+    bool find(const SymbolKey& key, QString* signature);
+
+    /*!
+     * \brief findMethod
+     *
+     * The signature of a method called \a name in the first of \a fileNames
+     * which has one, whatever its record.
+     */
+    bool findMethod(const QStringList& fileNames, const QString& name, QString* signature);
+
+private:
+    typedef QPair<QString, QString> ScopedName; // Enclosing declaration and name.
+
+    struct SignatureTable
+    {
+        QHash<ScopedName, QString> m_signatures;
+        QHash<QString, QString> m_methods;
+    };
+
+    typedef ShardedHash<QString, SignatureTable> Tables;
+
+    static SignatureTable buildTable(const QVector<DeclEntry>& decls, const QStringList& lines);
+    void publish(const QString& fileName, const SignatureTable* table);
+    const SignatureTable* table(const QString& fileName,
+                                std::shared_ptr<const Tables>* tables,
+                                SignatureTable* built);
+
+    QMutex m_writeLock;
+    std::shared_ptr<const Tables> m_tables;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -0,0 +1,84 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisointerner.h"
+
+#include <QMutexLocker>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+
+Interner* Interner::instance()
+{
+    static Interner interner;
+    return &interner;
+}
+
+QString Interner::intern(const QString& str)
+{
+    if (str.isEmpty())
+        return QString();
+
+    Shard& shard = m_shards[qHash(str) % kShards];
+    QMutexLocker locker(&shard.m_mutex);
+    auto it = shard.m_strings.constFind(str);
+    if (it != shard.m_strings.constEnd())
+        return *it;
+    shard.m_strings.insert(str);
+    return str;
+}
+
+QString Interner::intern(const std::string& str)
+{
+    if (str.empty())
+        return QString();
+
+    // Looked up without copying, the key is only copied when stored.
+    const QByteArray& raw = QByteArray::fromRawData(str.data(), static_cast<int>(str.size()));
+    Shard& shard = m_shards[qHash(raw) % kShards];
+    {
+        QMutexLocker locker(&shard.m_mutex);
+        auto it = shard.m_utf8.constFind(raw);
+        if (it != shard.m_utf8.constEnd())
+            return *it;
+    }
+
+    const QString& interned = intern(QString::fromStdString(str));
+    QMutexLocker locker(&shard.m_mutex);
+    shard.m_utf8.insert(QByteArray(str.data(), static_cast<int>(str.size())), interned);
+    return interned;
+}
+
+int Interner::size() const
+{
+    int size = 0;
+    for (const Shard& shard : m_shards) {
+        QMutexLocker locker(&shard.m_mutex);
+        size += shard.m_strings.size();
+    }
+    return size;
+}
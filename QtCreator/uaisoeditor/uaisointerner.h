@@ -0,0 +1,96 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_INTERNER_H
+#define UAISO_QTC_INTERNER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The Interner class
+ *
+ * A single copy of every identifier and file name that ends up in results
+ * and indexes. Each file's lexemes are unique only within the file, so
+ * without this names like self, err or ctx would be stored once per file
+ * referencing them. Interned strings share their buffer, which lets
+ * comparisons between equal ones succeed on the pointer.
+ *
+ * Thread-safe, split into shards so parallel passes rarely meet. Strings
+ * are never dropped, names in a workspace are a bounded set.
+ */
+class Interner
+{
+public:
+    static Interner* instance();
+
+    QString intern(const QString& str);
+    QString intern(const std::string& str);
+
+    int size() const;
+
+private:
+    Interner() = default;
+    Interner(const Interner&) = delete;
+    Interner& operator=(const Interner&) = delete;
+
+    static const int kShards = 16;
+
+    struct Shard
+    {
+        mutable QMutex m_mutex;
+        QSet<QString> m_strings;
+        QHash<QByteArray, QString> m_utf8; // Engine strings, no conversion on a hit.
+    };
+
+    Shard m_shards[kShards];
+};
+
+inline QString intern(const QString& str) { return Interner::instance()->intern(str); }
+inline QString intern(const std::string& str) { return Interner::instance()->intern(str); }
+
+/*!
+ * \brief isSameString
+ *
+ * Equality, short-circuiting on interned strings.
+ */
+inline bool isSameString(const QString& a, const QString& b)
+{
+    return a.constData() == b.constData() || a == b;
+}
+
+} // namespace UaisoQtc
+
+#endif
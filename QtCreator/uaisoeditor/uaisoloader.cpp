@@ -0,0 +1,340 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisoloader.h"
+#include "uaisomappedfile.h"
+#include "uaisopipeline.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QFuture>
+#include <QSet>
+#include <QThread>
+#include <QtConcurrentRun>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Ast/Ast.h>
+#include <Parsing/Factory.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Binder.h>
+#include <Semantic/Program.h>
+
+using namespace UaisoQtc;
+
+    //--------------------//
+    //--- Module Store ---//
+    //--------------------//
+
+void ModuleStore::keep(const std::shared_ptr<LoadedModule>& module)
+{
+    // Whatever was kept for the file is only released once the new program
+    // replaced it in the snapshot.
+    m_modules.insert(module->m_fileName, module);
+    m_stale.remove(module->m_fileName);
+}
+
+bool ModuleStore::contains(const QString& fileName) const
+{
+    return m_modules.contains(fileName) && !m_stale.contains(fileName);
+}
+
+QStringList ModuleStore::files() const
+{
+    QStringList files;
+    for (auto it = m_modules.constBegin(); it != m_modules.constEnd(); ++it) {
+        if (!m_stale.contains(it.key()))
+            files.append(it.key());
+    }
+    return files;
+}
+
+QStringList ModuleStore::invalidateDependencies(const QString& suffix)
+{
+    QStringList marked;
+    for (const std::shared_ptr<LoadedModule>& module : m_modules) {
+        if (!module->m_dependency)
+            continue;
+        if (!suffix.isEmpty() && !module->m_fileName.endsWith(QLatin1Char('.') + suffix))
+            continue;
+        m_stale.insert(module->m_fileName);
+        marked.append(module->m_fileName);
+    }
+    return marked;
+}
+
+    //---------------------//
+    //--- Module Loader ---//
+    //---------------------//
+
+ModuleLoader::ModuleLoader(uaiso::Factory* factory,
+                           uaiso::Snapshot snapshot,
+                           ModuleStore* store,
+                           const QStringList& searchPaths)
+    : m_factory(factory)
+    , m_snapshot(snapshot)
+    , m_store(store)
+    , m_searchPaths(searchPaths)
+    , m_suffix(sourceSuffix(factory->langName()))
+{
+    m_pool.setMaxThreadCount(QThread::idealThreadCount());
+}
+
+ModuleLoader::~ModuleLoader()
+{
+    m_pool.waitForDone();
+}
+
+bool ModuleLoader::isLoaded(const QString& fileName) const
+{
+    // A stale module's program is in the snapshot until it's replaced.
+    if (m_store->isStale(fileName))
+        return false;
+    return m_store->contains(fileName) || m_snapshot.find(fileName.toStdString());
+}
+
+QStringList ModuleLoader::load(const QString& fileName,
+                               const QStringList& imports,
+                               QStringList* failed)
+{
+    QStringList unresolved;
+    publish(fetch(fileName, imports,
+                  [this](const QString& file) { return isLoaded(file); },
+                  &unresolved, failed));
+    return unresolved;
+}
+
+QFuture<ModuleLoader::Fetched> ModuleLoader::fetchAsync(const QString& importer,
+                                                        const QStringList& imports)
+{
+    // The store can't be read from the worker, what it has now is enough,
+    // publishing skips anything loaded in the meantime.
+    const QSet<QString> known = m_store->files().toSet();
+    std::shared_ptr<ModuleLoader> self = shared_from_this();
+    return QtConcurrent::run([self, importer, imports, known]() {
+        Fetched fetched;
+        fetched.m_modules = self->fetch(importer, imports,
+                                        [&known](const QString& file) {
+                                            return known.contains(file);
+                                        },
+                                        &fetched.m_unresolved, &fetched.m_failed);
+        return fetched;
+    });
+}
+
+ModuleLoader::Modules ModuleLoader::fetch(const QString& importer,
+                                          const QStringList& imports,
+                                          const Filter& isKnown,
+                                          QStringList* unresolved,
+                                          QStringList* failed) const
+{
+    QStringList frontier;
+    QSet<QString> seen;
+    QHash<QString, QString> importOf;
+    for (const QString& import : imports) {
+        const QStringList& files = resolve(import, importer);
+        if (files.isEmpty() && unresolved)
+            unresolved->append(import);
+        for (const QString& file : files) {
+            if (!seen.contains(file) && !isKnown(file)) {
+                seen.insert(file);
+                frontier.append(file);
+                importOf.insert(file, import);
+            }
+        }
+    }
+
+    // Discover the graph wave by wave, everything in a wave is independent.
+    Modules modules;
+    while (!frontier.isEmpty()) {
+        QList<QFuture<std::shared_ptr<LoadedModule>>> futures;
+        for (const QString& file : frontier) {
+            futures.append(QtConcurrent::run(&m_pool, [this, file]() {
+                return loadModule(file);
+            }));
+        }
+
+        QStringList next;
+        for (QFuture<std::shared_ptr<LoadedModule>>& future : futures) {
+            std::shared_ptr<LoadedModule> module = future.result();
+            for (const QString& dep : module->m_deps) {
+                if (!seen.contains(dep) && !isKnown(dep)) {
+                    seen.insert(dep);
+                    next.append(dep);
+                }
+            }
+            modules.insert(module->m_fileName, module);
+        }
+        frontier = next;
+    }
+
+    if (failed) {
+        for (auto it = importOf.constBegin(); it != importOf.constEnd(); ++it) {
+            if (!modules.value(it.key())->m_prog && !failed->contains(it.value()))
+                failed->append(it.value());
+        }
+    }
+
+    return modules;
+}
+
+void ModuleLoader::publish(Modules modules)
+{
+    // Publish leaves first, a module goes in once all of its (new)
+    // dependencies are there. What's left in a cycle goes in as is.
+    QHash<QString, int> pending;
+    QHash<QString, QStringList> dependents;
+    QStringList ready;
+    for (const std::shared_ptr<LoadedModule>& module : modules) {
+        int count = 0;
+        for (const QString& dep : module->m_deps) {
+            if (modules.contains(dep) && dep != module->m_fileName) {
+                ++count;
+                dependents[dep].append(module->m_fileName);
+            }
+        }
+        pending.insert(module->m_fileName, count);
+        if (!count)
+            ready.append(module->m_fileName);
+    }
+
+    auto publishOne = [this, &modules](const QString& file) {
+        std::shared_ptr<LoadedModule> module = modules.take(file);
+        if (isLoaded(file))
+            return;
+
+        // A module which failed is left out, to be tried again.
+        const uaiso::Program* prog = module->m_prog.get();
+        if (!prog)
+            return;
+        m_snapshot.insertOrReplace(file.toStdString(), std::move(module->m_prog));
+        if (m_observer)
+            m_observer(file, prog);
+        m_store->keep(module);
+    };
+
+    while (!ready.isEmpty()) {
+        const QString file = ready.takeFirst();
+        for (const QString& dependent : dependents.value(file)) {
+            if (--pending[dependent] == 0)
+                ready.append(dependent);
+        }
+        publishOne(file);
+    }
+    for (const QString& file : modules.keys())
+        publishOne(file);
+}
+
+std::shared_ptr<LoadedModule> ModuleLoader::loadModule(const QString& fileName) const
+{
+    std::shared_ptr<LoadedModule> module(new LoadedModule);
+    module->m_fileName = fileName;
+    module->m_dependency = true;
+
+    // The input and the unit (its AST) are only needed until the module is
+    // bound, afterwards what stays is the program and the lexemes/tokens.
+    {
+        std::string input;
+        if (!m_source || !m_source(fileName, &input)) {
+            MappedFile file(fileName);
+            if (!file.isValid())
+                return module;
+            input = file.toStdString();
+        }
+        const std::string stdFileName = fileName.toStdString();
+
+        std::unique_ptr<uaiso::Unit> unit = m_factory->makeUnit();
+        unit->assignInput(input);
+        unit->setFileName(stdFileName);
+        unit->parse(&module->m_tokens, &module->m_lexemes);
+
+        uaiso::ProgramAst* progAst = Program_Cast(unit->ast());
+        if (!progAst)
+            return module;
+
+        uaiso::Binder binder(m_factory);
+        binder.setLexemes(&module->m_lexemes);
+        binder.setTokens(&module->m_tokens);
+        module->m_prog.reset(binder.bind(progAst, stdFileName));
+    }
+
+    for (const QString& import : importTargets(module->m_prog.get())) {
+        const QStringList& deps = resolve(import, fileName);
+        if (deps.isEmpty())
+            module->m_unresolved.append(import);
+        module->m_deps.append(deps);
+    }
+
+    return module;
+}
+
+QStringList ModuleLoader::resolve(const QString& import, const QString& importer) const
+{
+    if (m_resolver) {
+        const QStringList& files = m_resolver(import, importer);
+        if (!files.isEmpty())
+            return files;
+    }
+
+    // Imports are written with dots (Python, D) or slashes (Go), a module
+    // is either a file or a directory (a package).
+    QString path = import;
+    path.remove(QLatin1Char('"'));
+    path.replace(QLatin1Char('.'), QLatin1Char('/'));
+
+    const QString& suffix = m_suffix;
+    QStringList dirs;
+    if (!importer.isEmpty())
+        dirs << QFileInfo(importer).path();
+    dirs << m_searchPaths;
+
+    for (const QString& dir : dirs) {
+        const QString base = dir + QLatin1Char('/') + path;
+        const QFileInfo moduleFile(base + QLatin1Char('.') + suffix);
+        if (moduleFile.isFile())
+            return QStringList(moduleFile.absoluteFilePath());
+
+        const QDir package(base);
+        if (!package.exists())
+            continue;
+
+        const QFileInfo init(package.filePath(QLatin1String("__init__.") + suffix));
+        if (init.isFile())
+            return QStringList(init.absoluteFilePath());
+
+        QStringList files;
+        const QString testSuffix = QLatin1String("_test.") + suffix;
+        for (const QFileInfo& info : package.entryInfoList(
+                 QStringList(QLatin1String("*.") + suffix), QDir::Files)) {
+            if (!info.fileName().endsWith(testSuffix))
+                files.append(info.absoluteFilePath());
+        }
+        if (!files.isEmpty())
+            return files;
+    }
+
+    return QStringList();
+}
@@ -0,0 +1,225 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_LOADER_H
+#define UAISO_QTC_LOADER_H
+
+#include <QFuture>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <functional>
+#include <memory>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/LexemeMap.h>
+#include <Parsing/TokenMap.h>
+#include <Semantic/Snapshot.h>
+
+namespace uaiso {
+
+class Factory;
+class Program;
+
+}
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The LoadedModule struct
+ *
+ * A module parsed and bound off the GUI thread. It comes with lexemes and
+ * tokens of its own, so modules can be processed concurrently, and those
+ * must live as long as the module's program is in the snapshot.
+ */
+struct LoadedModule
+{
+    QString m_fileName;
+    uaiso::LexemeMap m_lexemes;
+    uaiso::TokenMap m_tokens;
+    std::unique_ptr<uaiso::Program> m_prog;
+    QStringList m_deps;
+    QStringList m_unresolved;
+    bool m_dependency { false };
+};
+
+/*!
+ * \brief The ModuleStore class
+ *
+ * Keeps alive what loaded modules in a snapshot refer to. It belongs with
+ * the snapshot, not with whoever loaded the modules.
+ *
+ * A stale module is still kept (its program is still in the snapshot) but
+ * no longer counts as loaded, the next load that reaches it replaces it.
+ */
+class ModuleStore
+{
+public:
+    void keep(const std::shared_ptr<LoadedModule>& module);
+    bool contains(const QString& fileName) const;
+    bool isStale(const QString& fileName) const { return m_stale.contains(fileName); }
+    QStringList files() const;
+    int size() const { return m_modules.size(); }
+
+    /*!
+     * \brief invalidateDependencies
+     *
+     * Mark stale the modules loaded as dependencies whose file name ends
+     * with \a suffix (all of them if it's empty). Open documents aren't
+     * touched. Return the files marked.
+     */
+    QStringList invalidateDependencies(const QString& suffix = QString());
+
+private:
+    QHash<QString, std::shared_ptr<LoadedModule>> m_modules;
+    QSet<QString> m_stale;
+};
+
+/*!
+ * \brief The ModuleLoader class
+ *
+ * Load the modules reachable from a file's imports. Each wave of newly
+ * discovered modules is parsed and bound in parallel on a bounded pool,
+ * then modules are published into the snapshot in topological order,
+ * dependencies first.
+ *
+ * Modules which fail to load aren't recorded, they're tried again by the
+ * next load that reaches them.
+ */
+class ModuleLoader : public std::enable_shared_from_this<ModuleLoader>
+{
+public:
+    ModuleLoader(uaiso::Factory* factory,
+                 uaiso::Snapshot snapshot,
+                 ModuleStore* store,
+                 const QStringList& searchPaths);
+    ~ModuleLoader();
+
+    typedef QHash<QString, std::shared_ptr<LoadedModule>> Modules;
+    typedef std::function<bool (const QString&)> Filter;
+    typedef std::function<bool (const QString&, std::string*)> Source;
+    typedef std::function<QStringList (const QString&, const QString&)> Resolver;
+    typedef std::function<void (const QString&, const uaiso::Program*)> Observer;
+
+    struct Fetched
+    {
+        Modules m_modules;
+        QStringList m_unresolved;
+        QStringList m_failed;
+    };
+
+    /*!
+     * \brief setSource
+     *
+     * Give \a source a chance to provide a module's code (a stub, say)
+     * before its file is read. It's called from loading threads.
+     */
+    void setSource(const Source& source) { m_source = source; }
+
+    /*!
+     * \brief setResolver
+     *
+     * Let \a resolver map an import to files before search paths are
+     * probed. It's called from loading threads.
+     */
+    void setResolver(const Resolver& resolver) { m_resolver = resolver; }
+
+    /*!
+     * \brief setObserver
+     *
+     * Let \a observer know of every program published into the snapshot.
+     * It's called from the publishing thread.
+     */
+    void setObserver(const Observer& observer) { m_observer = observer; }
+
+    void setMaxThreadCount(int count) { m_pool.setMaxThreadCount(count); }
+
+    /*!
+     * \brief load
+     *
+     * Fetch and publish, return the imports which couldn't be resolved to a
+     * file. Those resolved to a file which couldn't be loaded go to
+     * \a failed. It blocks until everything is loaded, the GUI thread
+     * should use fetchAsync instead.
+     */
+    QStringList load(const QString& fileName,
+                     const QStringList& imports,
+                     QStringList* failed = nullptr);
+
+    /*!
+     * \brief fetch
+     *
+     * Parse and bind what's reachable from \a imports, skipping files for
+     * which \a isKnown is true. It doesn't touch the snapshot, so it may run
+     * in any thread (as long as \a isKnown can). An empty \a importer means
+     * imports are looked up in search paths only.
+     */
+    Modules fetch(const QString& importer,
+                  const QStringList& imports,
+                  const Filter& isKnown,
+                  QStringList* unresolved = nullptr,
+                  QStringList* failed = nullptr) const;
+
+    /*!
+     * \brief fetchAsync
+     *
+     * Fetch in a worker, skipping files loaded by the time of the call. The
+     * result is for the caller to publish, from the GUI thread.
+     */
+    QFuture<Fetched> fetchAsync(const QString& importer, const QStringList& imports);
+
+    /*!
+     * \brief publish
+     *
+     * Insert fetched modules into the snapshot, dependencies first. Modules
+     * loaded in the meantime (by someone else) are left alone.
+     */
+    void publish(Modules modules);
+
+    QStringList resolve(const QString& import, const QString& importer) const;
+
+private:
+    std::shared_ptr<LoadedModule> loadModule(const QString& fileName) const;
+    bool isLoaded(const QString& fileName) const;
+
+    uaiso::Factory* m_factory;
+    uaiso::Snapshot m_snapshot;
+    ModuleStore* m_store;
+    QStringList m_searchPaths;
+    QString m_suffix;
+    Source m_source;
+    Resolver m_resolver;
+    Observer m_observer;
+    mutable QThreadPool m_pool;
+};
+
+} // namespace UaisoQtc
+
+#endif
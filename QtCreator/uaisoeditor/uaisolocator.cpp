@@ -0,0 +1,97 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisolocator.h"
+#include "uaisoeditor.h"
+#include "uaisoindex.h"
+
+#include <coreplugin/editormanager/editormanager.h>
+
+#include <QFileInfo>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+
+namespace {
+
+const size_t kMaxMatches = 1000;
+
+} // anonymous
+
+UaisoSymbolFilter::UaisoSymbolFilter(SymbolIndex *index)
+    : m_index(index)
+{
+    setId(Constants::LOCATOR_FILTER_ID);
+    setDisplayName(tr("Uaiso Symbols"));
+    setShortcutString(QString(QLatin1Char('u')));
+    setPriority(Medium);
+    setIncludedByDefault(false);
+}
+
+UaisoSymbolFilter::~UaisoSymbolFilter()
+{}
+
+QList<Core::LocatorFilterEntry>
+UaisoSymbolFilter::matchesFor(QFutureInterface<Core::LocatorFilterEntry> &future,
+                              const QString &entry)
+{
+    QList<Core::LocatorFilterEntry> entries;
+    if (entry.isEmpty())
+        return entries;
+
+    for (const SymbolLocation& loc : m_index->find(entry, kMaxMatches)) {
+        if (future.isCanceled())
+            break;
+
+        Core::LocatorFilterEntry filterEntry(this, loc.m_name, QVariant());
+        filterEntry.extraInfo = QString::fromLatin1("%1:%2")
+                .arg(QFileInfo(loc.m_fileName).fileName()).arg(loc.m_line + 1);
+        filterEntry.internalData = QVariant::fromValue(
+                    QStringList() << loc.m_fileName
+                                  << QString::number(loc.m_line)
+                                  << QString::number(loc.m_col));
+        entries.append(filterEntry);
+    }
+
+    return entries;
+}
+
+void UaisoSymbolFilter::accept(Core::LocatorFilterEntry selection) const
+{
+    const QStringList& data = selection.internalData.toStringList();
+    if (data.size() != 3)
+        return;
+
+    // Uaiso's lines are 0-based, the editor's are 1-based.
+    Core::EditorManager::openEditorAt(data.at(0),
+                                      data.at(1).toInt() + 1,
+                                      data.at(2).toInt());
+}
+
+void UaisoSymbolFilter::refresh(QFutureInterface<void> &)
+{
+    // The index is kept up-to-date as programs are bound.
+}
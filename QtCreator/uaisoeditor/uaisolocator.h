@@ -0,0 +1,56 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_LOCATOR_H
+#define UAISO_QTC_LOCATOR_H
+
+#include <coreplugin/locator/ilocatorfilter.h>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+class SymbolIndex;
+
+class UaisoSymbolFilter : public Core::ILocatorFilter
+{
+    Q_OBJECT
+
+public:
+    UaisoSymbolFilter(SymbolIndex* index);
+    ~UaisoSymbolFilter();
+
+    QList<Core::LocatorFilterEntry> matchesFor(QFutureInterface<Core::LocatorFilterEntry> &future,
+                                               const QString &entry) Q_DECL_OVERRIDE;
+    void accept(Core::LocatorFilterEntry selection) const Q_DECL_OVERRIDE;
+    void refresh(QFutureInterface<void> &future) Q_DECL_OVERRIDE;
+
+private:
+    SymbolIndex* m_index;
+};
+
+} // namespace UaisoQtc
+
+#endif
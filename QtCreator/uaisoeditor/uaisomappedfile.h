@@ -0,0 +1,76 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_MAPPEDFILE_H
+#define UAISO_QTC_MAPPEDFILE_H
+
+#include <QFile>
+#include <QString>
+
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The MappedFile class
+ *
+ * Read-only memory mapping of a source file. Pages come straight from the
+ * page cache, there's no intermediate buffer in between the file and the
+ * parser's input. The mapping goes away with the object or on release().
+ */
+class MappedFile
+{
+public:
+    explicit MappedFile(const QString& fileName);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool isValid() const { return m_data != nullptr || m_size == 0; }
+    const char* data() const { return reinterpret_cast<const char*>(m_data); }
+    qint64 size() const { return m_size; }
+
+    /*!
+     * \brief toStdString
+     *
+     * The engine takes its input as a std::string, this is the one copy.
+     */
+    std::string toStdString() const;
+
+    void release();
+
+private:
+    QFile m_file;
+    uchar* m_data;
+    qint64 m_size;
+};
+
+} // namespace UaisoQtc
+
+#endif
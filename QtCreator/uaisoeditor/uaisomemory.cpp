@@ -0,0 +1,421 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisomemory.h"
+#include "uaisoeditor.h"
+#include "uaisogo.h"
+#include "uaisointerner.h"
+#include "uaisomappedfile.h"
+#include "uaisoregistry.h"
+
+#include <coreplugin/editormanager/documentmodel.h>
+#include <coreplugin/icore.h>
+#include <texteditor/semantichighlighter.h>
+#include <texteditor/texteditorsettings.h>
+#include <utils/fileutils.h>
+
+#include <QFile>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QPlainTextEdit>
+#include <QSet>
+#include <QTextLayout>
+#include <QTextStream>
+#include <QToolButton>
+#include <QtConcurrentRun>
+
+#include <unordered_map>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/Diagnostic.h>
+#include <Parsing/Factory.h>
+#include <Parsing/IncrementalLexer.h>
+#include <Parsing/Phrasing.h>
+#include <Parsing/Token.h>
+#include <Parsing/TokenCategory.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Environment.h>
+#include <Semantic/Program.h>
+#include <Semantic/Snapshot.h>
+
+using namespace UaisoQtc;
+using namespace TextEditor;
+
+namespace {
+
+// Rough per-entry costs, including container overhead, of the engine's
+// data structures. They're only meant to make files comparable, figures
+// derived from them are shown as estimates (~).
+const qint64 kTokenEntryBytes = 24;
+const qint64 kLexemeEntryBytes = 48;
+const qint64 kAstBytesPerToken = 40;
+const qint64 kSymbolBytes = 96;
+
+struct TokenStats
+{
+    qint64 m_tokens { 0 };
+    qint64 m_lexemes { 0 };
+    qint64 m_lexemeChars { 0 };
+};
+
+TokenStats computeTokenStats(uaiso::Factory* factory, const std::string& code)
+{
+    TokenStats stats;
+    std::unique_ptr<uaiso::IncrementalLexer> lexer = factory->makeIncrementalLexer();
+    lexer->lex(code);
+    std::unique_ptr<uaiso::Phrasing> phrasing(lexer->releasePhrasing());
+    if (!phrasing)
+        return stats;
+
+    stats.m_tokens = phrasing->size();
+    for (size_t i = 0; i < phrasing->size(); ++i) {
+        uaiso::Token tk = phrasing->token(i);
+        if (tk == uaiso::TK_IDENTIFIER || uaiso::isStrLit(tk) || uaiso::isNumLit(tk)) {
+            ++stats.m_lexemes;
+            stats.m_lexemeChars += phrasing->length(i);
+        }
+    }
+    return stats;
+}
+
+void fillEngineEstimates(MemoryUsage* usage, uaiso::Factory* factory, const std::string& code)
+{
+    const TokenStats stats = computeTokenStats(factory, code);
+    usage->m_tokens = stats.m_tokens * kTokenEntryBytes;
+    usage->m_lexemes = stats.m_lexemes * kLexemeEntryBytes + stats.m_lexemeChars;
+    usage->m_ast = stats.m_tokens * kAstBytesPerToken;
+}
+
+qint64 programBytes(const std::string& fileName)
+{
+    const uaiso::Program* prog = UaisoEditorPlugin::instance()->snapshot().find(fileName);
+    if (!prog)
+        return 0;
+    return static_cast<qint64>(prog->env().list().size()) * kSymbolBytes;
+}
+
+MemoryUsage documentUsage(UaisoEditorDocument* doc)
+{
+    MemoryUsage usage;
+    usage.m_fileName = doc->filePath().toString();
+
+    // The editor's own copy is UTF-16, the engine's is the Unit's input.
+    const QString& text = doc->plainText();
+    usage.m_text = text.size() * sizeof(QChar) + text.toUtf8().size();
+
+    for (const DiagnosticEntry& diagnostic : doc->m_diagnostics)
+        usage.m_reports += sizeof(DiagnosticEntry) + diagnostic.m_desc.size() * sizeof(QChar);
+
+    usage.m_highlighting = doc->highlightingCount()
+            * (sizeof(HighlightingResult) + sizeof(QTextLayout::FormatRange));
+
+    if (doc->m_factory)
+        usage.m_program = programBytes(usage.m_fileName.toStdString());
+
+    return usage;
+}
+
+QString formatBytes(qint64 bytes)
+{
+    if (bytes >= 1024 * 1024)
+        return QString::fromLatin1("%1 MB").arg(bytes / (1024.0 * 1024.0), 0, 'f', 1);
+    if (bytes >= 1024)
+        return QString::fromLatin1("%1 KB").arg(bytes / 1024.0, 0, 'f', 1);
+    return QString::fromLatin1("%1 B").arg(bytes);
+}
+
+void appendUsages(QTextStream& out, const QVector<MemoryUsage>& usages)
+{
+    qint64 total = 0;
+    for (const MemoryUsage& usage : usages) {
+        out << QFileInfo(usage.m_fileName).fileName() << QLatin1String(": ")
+            << formatBytes(usage.total()) << QLatin1String(" (text ")
+            << formatBytes(usage.m_text) << QLatin1String(", ast ~")
+            << formatBytes(usage.m_ast) << QLatin1String(", diagnostics ")
+            << formatBytes(usage.m_reports) << QLatin1String(", highlighting ")
+            << formatBytes(usage.m_highlighting) << QLatin1String(", program ~")
+            << formatBytes(usage.m_program) << QLatin1String(")  ")
+            << usage.m_fileName << QLatin1Char('\n');
+        total += usage.total();
+    }
+    out << QLatin1String("Total: ") << formatBytes(total) << QLatin1String("\n\n");
+}
+
+} // anonymous
+
+    //--- Report ---//
+
+qint64 MemoryUsage::total() const
+{
+    return m_text + m_ast + m_reports + m_highlighting + m_program
+            + m_tokens + m_lexemes;
+}
+
+MemoryReport MemoryReport::gather()
+{
+    MemoryReport report;
+
+    QSet<QString> open;
+    for (Core::IDocument* document : Core::DocumentModel::openedDocuments()) {
+        auto doc = qobject_cast<UaisoEditorDocument*>(document);
+        if (!doc)
+            continue;
+        report.m_documents.append(documentUsage(doc));
+        open.insert(doc->filePath().toString());
+
+        uaiso::LangId lang;
+        if (doc->m_unit && doc->m_unit->ast()
+                && langIdForFile(doc->filePath().toString(), &lang)) {
+            report.m_sources.append(Source { true, report.m_documents.size() - 1, lang,
+                                             doc->plainText().toStdString() });
+        }
+    }
+
+    // Documents and the modules loaded for them, dependencies aren't open
+    // but their tokens and lexemes are still alive.
+    UaisoEditorPlugin* plugin = UaisoEditorPlugin::instance();
+    for (const QString& fileName : plugin->snapshotFiles()) {
+        MemoryUsage usage;
+        usage.m_fileName = fileName;
+        usage.m_program = programBytes(fileName.toStdString());
+        report.m_snapshot.append(usage);
+
+        uaiso::LangId lang;
+        if (!open.contains(fileName) && langIdForFile(fileName, &lang))
+            report.m_sources.append(Source { false, report.m_snapshot.size() - 1, lang, std::string() });
+    }
+    report.m_unresolved = plugin->unresolvedImports();
+    report.m_interned = Interner::instance()->size();
+    report.m_goPackages = plugin->goPackageIndex()->size();
+
+    return report;
+}
+
+void MemoryReport::estimate()
+{
+    // Factories of our own, the languages' ones are busy elsewhere.
+    std::unordered_map<int, std::unique_ptr<uaiso::Factory>> factories;
+    for (Source& source : m_sources) {
+        std::unique_ptr<uaiso::Factory>& factory = factories[static_cast<int>(source.m_lang)];
+        if (!factory)
+            factory = uaiso::FactoryCreator::create(source.m_lang);
+
+        MemoryUsage& usage = source.m_document ? m_documents[source.m_index]
+                                               : m_snapshot[source.m_index];
+        if (source.m_document) {
+            fillEngineEstimates(&usage, factory.get(), source.m_code);
+        } else {
+            MappedFile file(usage.m_fileName);
+            if (!file.isValid())
+                continue;
+            fillEngineEstimates(&usage, factory.get(), file.toStdString());
+            usage.m_ast = 0; // Dependencies' ASTs are discarded after binding.
+        }
+    }
+    m_sources.clear();
+
+    QSet<QString> open;
+    for (const MemoryUsage& usage : m_documents) {
+        open.insert(usage.m_fileName);
+        m_tokens += usage.m_tokens;
+        m_lexemes += usage.m_lexemes;
+    }
+    for (const MemoryUsage& usage : m_snapshot) {
+        if (open.contains(usage.m_fileName))
+            continue;
+        m_tokens += usage.m_tokens;
+        m_lexemes += usage.m_lexemes;
+    }
+}
+
+QString MemoryReport::toText() const
+{
+    QString text;
+    QTextStream out(&text);
+
+    out << QLatin1String("Documents\n");
+    appendUsages(out, m_documents);
+    out << QLatin1String("Snapshot entries\n");
+    appendUsages(out, m_snapshot);
+    if (!m_unresolved.isEmpty()) {
+        out << QLatin1String("Unresolved imports (nothing loaded): ")
+            << m_unresolved.join(QLatin1String(", ")) << QLatin1String("\n\n");
+    }
+    out << QLatin1String("Token map: ~") << formatBytes(m_tokens) << QLatin1Char('\n')
+        << QLatin1String("Lexeme map: ~") << formatBytes(m_lexemes) << QLatin1Char('\n')
+        << QLatin1String("Interned names and file names: ") << m_interned << QLatin1Char('\n')
+        << QLatin1String("Go packages indexed: ") << m_goPackages << QLatin1Char('\n')
+        << QLatin1String("\n~ Estimated from token counts, the engine doesn't report sizes.\n");
+
+    return text;
+}
+
+    //--- Pane ---//
+
+UaisoMemoryPane::UaisoMemoryPane(QObject *parent)
+    : Core::IOutputPane(parent)
+    , m_refreshButton(new QToolButton)
+    , m_saveButton(new QToolButton)
+{
+    m_refreshButton->setText(tr("Refresh"));
+    m_refreshButton->setToolTip(tr("Recompute memory usage"));
+    connect(m_refreshButton, &QToolButton::clicked, this, &UaisoMemoryPane::refresh);
+
+    m_saveButton->setText(tr("Save"));
+    m_saveButton->setToolTip(tr("Dump memory usage to a file"));
+    connect(m_saveButton, &QToolButton::clicked, this, &UaisoMemoryPane::save);
+
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(reportReady()));
+}
+
+UaisoMemoryPane::~UaisoMemoryPane()
+{
+    m_watcher.waitForFinished();
+    delete m_refreshButton;
+    delete m_saveButton;
+    delete m_output;
+}
+
+QWidget *UaisoMemoryPane::outputWidget(QWidget *parent)
+{
+    if (!m_output) {
+        m_output = new QPlainTextEdit(parent);
+        m_output->setReadOnly(true);
+        m_output->setFrameStyle(QFrame::NoFrame);
+        m_output->setFont(TextEditor::TextEditorSettings::fontSettings().font());
+    }
+    return m_output;
+}
+
+QList<QWidget *> UaisoMemoryPane::toolBarWidgets() const
+{
+    return QList<QWidget *>() << m_refreshButton << m_saveButton;
+}
+
+QString UaisoMemoryPane::displayName() const
+{
+    return tr("Uaiso Memory");
+}
+
+int UaisoMemoryPane::priorityInStatusBar() const
+{
+    return -1;
+}
+
+void UaisoMemoryPane::clearContents()
+{
+    if (m_output)
+        m_output->clear();
+}
+
+void UaisoMemoryPane::visibilityChanged(bool visible)
+{
+    if (visible)
+        refresh();
+}
+
+void UaisoMemoryPane::setFocus()
+{
+    if (m_output)
+        m_output->setFocus();
+}
+
+bool UaisoMemoryPane::hasFocus() const
+{
+    return m_output && m_output->hasFocus();
+}
+
+bool UaisoMemoryPane::canFocus() const
+{
+    return true;
+}
+
+bool UaisoMemoryPane::canNavigate() const
+{
+    return false;
+}
+
+bool UaisoMemoryPane::canNext() const
+{
+    return false;
+}
+
+bool UaisoMemoryPane::canPrevious() const
+{
+    return false;
+}
+
+void UaisoMemoryPane::goToNext()
+{}
+
+void UaisoMemoryPane::goToPrev()
+{}
+
+void UaisoMemoryPane::refresh()
+{
+    // A refresh in flight will do, its report is as recent.
+    if (m_watcher.isRunning())
+        return;
+
+    // Lexing every file (and reading dependencies) is left to a worker.
+    MemoryReport report = MemoryReport::gather();
+    m_watcher.setFuture(QtConcurrent::run([report]() mutable {
+        report.estimate();
+        return report;
+    }));
+}
+
+void UaisoMemoryPane::reportReady()
+{
+    const QString& text = m_watcher.result().toText();
+    if (m_output)
+        m_output->setPlainText(text);
+
+    if (m_saveFileName.isEmpty())
+        return;
+    QFile file(m_saveFileName);
+    m_saveFileName.clear();
+    if (file.open(QIODevice::WriteOnly | QIODevice::Text))
+        file.write(text.toUtf8());
+}
+
+void UaisoMemoryPane::dump()
+{
+    popup(Core::IOutputPane::NoModeSwitch);
+    refresh();
+}
+
+void UaisoMemoryPane::save()
+{
+    const QString fileName = QFileDialog::getSaveFileName(Core::ICore::dialogParent(),
+                                                          tr("Save Memory Usage"));
+    if (fileName.isEmpty())
+        return;
+
+    // Written once the report is ready.
+    m_saveFileName = fileName;
+    refresh();
+}
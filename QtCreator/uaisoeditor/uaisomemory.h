@@ -0,0 +1,145 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_MEMORY_H
+#define UAISO_QTC_MEMORY_H
+
+#include <coreplugin/ioutputpane.h>
+
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/LangId.h>
+
+QT_BEGIN_NAMESPACE
+class QPlainTextEdit;
+class QToolButton;
+QT_END_NAMESPACE
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The MemoryUsage struct
+ *
+ * Bytes held on behalf of a single file. Figures for engine-owned data
+ * (AST, program, token and lexeme entries) are estimates derived from the
+ * file's token stream, since the engine doesn't expose allocation sizes.
+ */
+struct MemoryUsage
+{
+    QString m_fileName;
+    qint64 m_text { 0 };
+    qint64 m_ast { 0 };
+    qint64 m_reports { 0 };
+    qint64 m_highlighting { 0 };
+    qint64 m_program { 0 };
+    qint64 m_tokens { 0 };
+    qint64 m_lexemes { 0 };
+    int m_interned { 0 }; // Distinct strings, each stored once for all files.
+    int m_goPackages { 0 }; // Import paths found by the last GOROOT/GOPATH scan.
+
+    qint64 total() const;
+};
+
+/*!
+ * \brief The MemoryReport struct
+ *
+ * Built in two steps: gather() takes what's cheap to read on the GUI
+ * thread, estimate() then lexes documents and dependencies (read from
+ * disk) on a worker.
+ */
+struct MemoryReport
+{
+    QVector<MemoryUsage> m_documents;
+    QVector<MemoryUsage> m_snapshot;
+    QStringList m_unresolved; // Imports no module was loaded for.
+    qint64 m_tokens { 0 };
+    qint64 m_lexemes { 0 };
+
+    static MemoryReport gather();
+    void estimate();
+
+    QString toText() const;
+
+private:
+    struct Source
+    {
+        bool m_document;
+        int m_index;
+        uaiso::LangId m_lang;
+        std::string m_code; // Read from disk if empty.
+    };
+    QVector<Source> m_sources;
+};
+
+class UaisoMemoryPane : public Core::IOutputPane
+{
+    Q_OBJECT
+
+public:
+    UaisoMemoryPane(QObject *parent = 0);
+    ~UaisoMemoryPane();
+
+    QWidget *outputWidget(QWidget *parent) Q_DECL_OVERRIDE;
+    QList<QWidget *> toolBarWidgets() const Q_DECL_OVERRIDE;
+    QString displayName() const Q_DECL_OVERRIDE;
+    int priorityInStatusBar() const Q_DECL_OVERRIDE;
+    void clearContents() Q_DECL_OVERRIDE;
+    void visibilityChanged(bool visible) Q_DECL_OVERRIDE;
+    void setFocus() Q_DECL_OVERRIDE;
+    bool hasFocus() const Q_DECL_OVERRIDE;
+    bool canFocus() const Q_DECL_OVERRIDE;
+    bool canNavigate() const Q_DECL_OVERRIDE;
+    bool canNext() const Q_DECL_OVERRIDE;
+    bool canPrevious() const Q_DECL_OVERRIDE;
+    void goToNext() Q_DECL_OVERRIDE;
+    void goToPrev() Q_DECL_OVERRIDE;
+
+public slots:
+    void refresh();
+    void dump();
+    void save();
+
+private slots:
+    void reportReady();
+
+private:
+    QPointer<QPlainTextEdit> m_output;
+    QFutureWatcher<MemoryReport> m_watcher;
+    QString m_saveFileName;
+    QToolButton *m_refreshButton;
+    QToolButton *m_saveButton;
+};
+
+} // namespace UaisoQtc
+
+#endif
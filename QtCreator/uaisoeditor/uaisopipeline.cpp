@@ -0,0 +1,629 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisopipeline.h"
+#include "uaisodependencies.h"
+#include "uaisointerner.h"
+#include "uaisoloader.h"
+
+#include <QFileInfo>
+#include <QHash>
+
+#include <algorithm>
+#include <unordered_set>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Ast/Ast.h>
+#include <Parsing/Diagnostic.h>
+#include <Parsing/Factory.h>
+#include <Parsing/SourceLoc.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Binder.h>
+#include <Semantic/CompletionProposer.h>
+#include <Semantic/Environment.h>
+#include <Semantic/Import.h>
+#include <Semantic/Manager.h>
+#include <Semantic/Program.h>
+#include <Semantic/Symbol.h>
+#include <Semantic/SymbolCollector.h>
+#include <Semantic/TypeChecker.h>
+
+using namespace UaisoQtc;
+
+    //--------------------//
+    //--- Plain results ---//
+    //--------------------//
+
+uint UaisoQtc::qHash(const SymbolKey& key, uint seed)
+{
+    return ::qHash(key.m_fileName, seed) ^ ::qHash(key.m_scope, seed) ^ ::qHash(key.m_name, seed)
+            ^ (uint(key.m_kind) << 24) ^ uint(key.m_offset);
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const SymbolKey& key)
+{
+    return out << key.m_fileName << key.m_scope << key.m_name << qint32(key.m_kind)
+               << qint32(key.m_offset) << qint32(key.m_line) << qint32(key.m_col);
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, SymbolKey& key)
+{
+    qint32 kind, offset, line, col;
+    in >> key.m_fileName >> key.m_scope >> key.m_name >> kind >> offset >> line >> col;
+    key.m_fileName = intern(key.m_fileName);
+    key.m_scope = intern(key.m_scope);
+    key.m_name = intern(key.m_name);
+    key.m_kind = kind;
+    key.m_offset = offset;
+    key.m_line = line;
+    key.m_col = col;
+    return in;
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const DiagnosticEntry& entry)
+{
+    return out << qint32(entry.m_line) << qint32(entry.m_col) << qint32(entry.m_lastCol)
+               << entry.m_warning << entry.m_desc;
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, DiagnosticEntry& entry)
+{
+    qint32 line, col, lastCol;
+    in >> line >> col >> lastCol >> entry.m_warning >> entry.m_desc;
+    entry.m_line = line;
+    entry.m_col = col;
+    entry.m_lastCol = lastCol;
+    return in;
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const SymbolRef& ref)
+{
+    return out << qint32(ref.m_line) << qint32(ref.m_col) << qint32(ref.m_length)
+               << qint32(ref.m_kind) << ref.m_key;
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, SymbolRef& ref)
+{
+    qint32 line, col, length, kind;
+    in >> line >> col >> length >> kind >> ref.m_key;
+    ref.m_line = line;
+    ref.m_col = col;
+    ref.m_length = length;
+    ref.m_kind = kind;
+    return in;
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const DeclEntry& entry)
+{
+    return out << entry.m_name << qint32(entry.m_line) << qint32(entry.m_col)
+               << qint32(entry.m_kind);
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, DeclEntry& entry)
+{
+    qint32 line, col, kind;
+    in >> entry.m_name >> line >> col >> kind;
+    entry.m_name = intern(entry.m_name);
+    entry.m_line = line;
+    entry.m_col = col;
+    entry.m_kind = kind;
+    return in;
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const ProposalEntry& entry)
+{
+    return out << entry.m_name << qint32(entry.m_kind) << qint32(entry.m_distance);
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, ProposalEntry& entry)
+{
+    qint32 kind, distance;
+    in >> entry.m_name >> kind >> distance;
+    entry.m_name = intern(entry.m_name);
+    entry.m_kind = kind;
+    entry.m_distance = distance;
+    return in;
+}
+
+QDataStream& UaisoQtc::operator<<(QDataStream& out, const AnalysisResult& result)
+{
+    return out << result.m_diagnostics << result.m_refs << result.m_decls << result.m_imports;
+}
+
+QDataStream& UaisoQtc::operator>>(QDataStream& in, AnalysisResult& result)
+{
+    return in >> result.m_diagnostics >> result.m_refs >> result.m_decls >> result.m_imports;
+}
+
+    //---------------//
+    //--- Helpers ---//
+    //---------------//
+
+void UaisoQtc::addSearchPaths(uaiso::Manager* manager, const QStringList& paths)
+{
+    foreach (const QString& path, paths)
+        manager->addSearchPath(path.toStdString());
+}
+
+QString UaisoQtc::sourceSuffix(uaiso::LangId lang)
+{
+    switch (lang) {
+    case uaiso::LangId::D:
+        return QLatin1String("d");
+    case uaiso::LangId::Go:
+        return QLatin1String("go");
+    case uaiso::LangId::Py:
+        return QLatin1String("py");
+    default:
+        return QString();
+    }
+}
+
+bool UaisoQtc::langIdForFile(const QString& fileName, uaiso::LangId* lang)
+{
+    const QString& suffix = QFileInfo(fileName).suffix();
+    if (suffix == QLatin1String("d"))
+        *lang = uaiso::LangId::D;
+    else if (suffix == QLatin1String("go"))
+        *lang = uaiso::LangId::Go;
+    else if (suffix == QLatin1String("py"))
+        *lang = uaiso::LangId::Py;
+    else
+        return false;
+    return true;
+}
+
+quint64 UaisoQtc::contentHash(const QString& fileName, const QString& text)
+{
+    quint64 hash = 14695981039346656037ULL;
+    auto feed = [&hash](const QString& s) {
+        const uchar* data = reinterpret_cast<const uchar*>(s.constData());
+        const int size = s.size() * static_cast<int>(sizeof(QChar));
+        for (int i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    feed(fileName);
+    hash ^= 0xff; // Keep the name apart from the text.
+    feed(text);
+    return hash;
+}
+
+int UaisoQtc::charColumn(const std::string& line, int byteCol)
+{
+    const int size = std::min(byteCol, static_cast<int>(line.size()));
+    return QString::fromUtf8(line.data(), size).size() + byteCol - size;
+}
+
+namespace {
+
+const int kMaxHeaderLines = 8;
+
+bool isIdentChar(QChar c)
+{
+    return c.isLetterOrNumber() || c == QLatin1Char('_');
+}
+
+int indentOf(const QString& line)
+{
+    int indent = 0;
+    while (indent < line.size() && line.at(indent).isSpace())
+        ++indent;
+    return indent;
+}
+
+// A member function's header: a name opening a parameter list, preceded by
+// words only (a keyword, a return type). Return the name's column, -1 if
+// the line isn't one.
+int methodHeader(const QString& line, int indent, QString* name)
+{
+    static const QStringList statements = QStringList()
+            << QLatin1String("if") << QLatin1String("elif") << QLatin1String("while")
+            << QLatin1String("for") << QLatin1String("foreach") << QLatin1String("switch")
+            << QLatin1String("return") << QLatin1String("with") << QLatin1String("assert");
+
+    const int open = line.indexOf(QLatin1Char('('), indent);
+    int start = open;
+    while (start > indent && isIdentChar(line.at(start - 1)))
+        --start;
+    if (open < 0 || start == open || line.at(start).isNumber())
+        return -1;
+
+    const QString& prefix = line.mid(indent, start - indent);
+    for (const QChar c : prefix) {
+        if (!isIdentChar(c) && !c.isSpace() && c != QLatin1Char('*') && c != QLatin1Char('&'))
+            return -1;
+    }
+    const QStringList& words = prefix.split(QLatin1Char(' '), QString::SkipEmptyParts);
+    if (!words.isEmpty() && statements.contains(words.last()))
+        return -1;
+
+    *name = line.mid(start, open - start);
+    return start;
+}
+
+} // anonymous
+
+QString UaisoQtc::declarationHeader(const QStringList& lines, int line, int col)
+{
+    if (line < 0 || line >= lines.size())
+        return QString();
+
+    QString text;
+    int depth = 0;
+    bool hasParams = false;
+    const int last = std::min(lines.size(), line + kMaxHeaderLines);
+    for (int i = line; i < last; ++i) {
+        const QString& current = lines.at(i);
+        for (int j = i == line ? col : 0; j < current.size(); ++j) {
+            const QChar c = current.at(j);
+            if (c == QLatin1Char('(')) {
+                ++depth;
+                hasParams = true;
+            } else if (c == QLatin1Char(')')) {
+                --depth;
+            } else if (depth == 0 && (c == QLatin1Char('{') || c == QLatin1Char(':')
+                                      || c == QLatin1Char(';') || c == QLatin1Char('='))) {
+                return hasParams ? text.simplified() : QString();
+            }
+            text.append(c);
+        }
+        text.append(QLatin1Char(' '));
+    }
+    return hasParams && depth == 0 ? text.simplified() : QString();
+}
+
+QVector<MemberEntry> UaisoQtc::recordMembers(const QStringList& lines, int line, int end)
+{
+    QVector<MemberEntry> members;
+    if (line < 0 || line >= lines.size())
+        return members;
+
+    const int outer = indentOf(lines.at(line));
+    int inner = -1;
+    end = std::min(end, lines.size());
+    for (int i = line + 1; i < end; ++i) {
+        const QString& text = lines.at(i);
+        const int indent = indentOf(text);
+        if (indent == text.size() || indent <= outer)
+            continue;
+        if (inner < 0)
+            inner = indent;
+        if (indent != inner)
+            continue;
+
+        MemberEntry member;
+        member.m_line = i;
+        member.m_col = methodHeader(text, indent, &member.m_name);
+        if (member.m_col >= 0)
+            member.m_header = declarationHeader(lines, i, member.m_col);
+        if (member.m_header.isEmpty()) {
+            member.m_name.clear();
+            member.m_col = indent;
+            member.m_header = text.trimmed();
+        }
+        members.append(member);
+    }
+    return members;
+}
+
+QVector<DiagnosticEntry> UaisoQtc::diagnosticEntries(const uaiso::DiagnosticReports* reports)
+{
+    QVector<DiagnosticEntry> entries;
+    if (!reports)
+        return entries;
+
+    for (const uaiso::DiagnosticReport& report : *reports) {
+        DiagnosticEntry entry;
+        entry.m_line = report.sourceLoc().line_;
+        entry.m_col = report.sourceLoc().col_;
+        entry.m_lastCol = report.sourceLoc().lastCol_;
+        entry.m_warning = report.diagnostic().severity() == uaiso::Severity::Warning;
+        entry.m_desc = QString::fromStdString(report.diagnostic().desc());
+        entries.append(entry);
+    }
+    return entries;
+}
+
+QVector<DeclEntry> UaisoQtc::declEntries(const uaiso::Program* prog)
+{
+    QVector<DeclEntry> entries;
+    if (!prog)
+        return entries;
+
+    for (const uaiso::DeclSymbol* decl : prog->env().list()) {
+        DeclEntry entry;
+        entry.m_name = intern(decl->name()->str());
+        entry.m_line = decl->sourceLoc().line_;
+        entry.m_col = decl->sourceLoc().col_;
+        entry.m_kind = static_cast<int>(decl->kind());
+        entries.append(entry);
+    }
+    return entries;
+}
+
+QStringList UaisoQtc::importTargets(const uaiso::Program* prog)
+{
+    QStringList targets;
+    if (!prog)
+        return targets;
+
+    for (const auto& import : prog->env().imports())
+        targets.append(QString::fromStdString(import->target()));
+    return targets;
+}
+
+namespace {
+
+SymbolKey symbolKey(const QString& fileName,
+                    const uaiso::Symbol* sym,
+                    const QVector<DeclEntry>& decls)
+{
+    const uaiso::SourceLoc& loc = sym->sourceLoc();
+    SymbolKey key;
+    key.m_fileName = fileName;
+    if (uaiso::isDecl(sym))
+        key.m_name = intern(ConstDeclSymbol_Cast(sym)->name()->str());
+    else if (sym->kind() == uaiso::Symbol::Kind::Namespace)
+        key.m_name = intern(ConstNamespace_Cast(sym)->name()->str());
+    key.m_kind = static_cast<int>(sym->kind());
+    key.m_line = loc.line_;
+    key.m_col = loc.col_;
+
+    // The last top-level declaration starting before the symbol encloses
+    // it, unless that's the symbol itself.
+    auto decl = std::upper_bound(decls.begin(), decls.end(), loc.line_,
+                                 [](int line, const DeclEntry& entry) {
+        return line < entry.m_line;
+    });
+    if (decl == decls.begin())
+        return key;
+    --decl;
+    if (decl->m_line == loc.line_ && decl->m_col == loc.col_)
+        return key;
+
+    key.m_scope = decl->m_name;
+    if (sym->kind() == uaiso::Symbol::Kind::Var || sym->kind() == uaiso::Symbol::Kind::Param)
+        key.m_offset = loc.line_ - decl->m_line;
+    return key;
+}
+
+} // anonymous
+
+QVector<SymbolRef> UaisoQtc::collectSymbolRefs(uaiso::Factory* factory,
+                                               uaiso::ProgramAst* progAst,
+                                               const uaiso::LexemeMap* lexemes,
+                                               const QString& fileName,
+                                               const DeclLookup& decls,
+                                               const CancellationToken& token)
+{
+    if (token.isCanceled())
+        return QVector<SymbolRef>();
+
+    uaiso::SymbolCollector collector(factory);
+    auto refs = collector.collect(progAst, lexemes);
+    if (token.isCanceled())
+        return QVector<SymbolRef>();
+
+    // Refs mostly point to a handful of files, their declarations are
+    // looked up once, sorted by line.
+    const QString& localFileName = intern(fileName);
+    QHash<QString, QVector<DeclEntry>> declsByFile;
+    QVector<SymbolRef> symRefs;
+    symRefs.reserve(static_cast<int>(refs.size()));
+    for (auto ref : refs) {
+        if (token.isCanceled())
+            return QVector<SymbolRef>();
+        auto sym = std::get<1>(ref);
+        auto loc = std::get<2>(ref);
+        const uaiso::SourceLoc& declLoc = sym->sourceLoc();
+        const QString& declFileName = declLoc.fileName_.empty()
+                ? localFileName : intern(declLoc.fileName_);
+        auto fileDecls = declsByFile.find(declFileName);
+        if (fileDecls == declsByFile.end()) {
+            QVector<DeclEntry> entries = decls ? decls(declFileName) : QVector<DeclEntry>();
+            std::sort(entries.begin(), entries.end(), [](const DeclEntry& a, const DeclEntry& b) {
+                return a.m_line != b.m_line ? a.m_line < b.m_line : a.m_col < b.m_col;
+            });
+            fileDecls = declsByFile.insert(declFileName, entries);
+        }
+
+        SymbolRef symRef;
+        symRef.m_line = loc.line_;
+        symRef.m_col = loc.col_;
+        symRef.m_length = loc.lastCol_ - loc.col_;
+        symRef.m_kind = static_cast<int>(sym->kind());
+        symRef.m_key = symbolKey(declFileName, sym, *fileDecls);
+        symRefs.append(symRef);
+    }
+    return symRefs;
+}
+
+QVector<ProposalEntry> UaisoQtc::proposeCompletions(uaiso::Factory* factory,
+                                                    const QStringList& searchPaths,
+                                                    const std::string& code,
+                                                    const QString& fileName,
+                                                    int line, int col,
+                                                    const CancellationToken& token)
+{
+    QVector<ProposalEntry> proposals;
+
+    uaiso::LexemeMap lexemes;
+    uaiso::TokenMap tokens;
+    uaiso::Snapshot snapshot;
+    uaiso::Manager manager;
+    manager.config(factory, &tokens, &lexemes, snapshot);
+    addSearchPaths(&manager, searchPaths);
+    std::unique_ptr<uaiso::Unit> unit = manager.process(code,
+                                                        fileName.toStdString(),
+                                                        uaiso::LineCol(line, col));
+    if (!unit->ast() || token.isCanceled())
+        return proposals;
+
+    uaiso::TypeChecker checker(factory);
+    checker.setLexemes(&lexemes);
+    checker.setTokens(&tokens);
+    checker.check(Program_Cast(unit->ast()));
+    if (token.isCanceled())
+        return proposals;
+
+    uaiso::CompletionProposer proposer(factory);
+    auto result = proposer.propose(Program_Cast(unit->ast()), &lexemes);
+    auto syms = std::get<0>(result);
+
+    // What's in the file's environment is at its top level, the rest of the
+    // file's symbols are nested.
+    const std::string stdFileName = fileName.toStdString();
+    const std::string dirName = QFileInfo(fileName).path().toStdString() + '/';
+    std::unordered_set<const uaiso::Symbol*> topLevel;
+    if (const uaiso::Program* prog = snapshot.find(stdFileName)) {
+        for (const uaiso::DeclSymbol* decl : prog->env().list())
+            topLevel.insert(decl);
+    }
+
+    for (const uaiso::Symbol* sym : syms) {
+        ProposalEntry entry;
+        if (uaiso::isDecl(sym))
+            entry.m_name = intern(ConstDeclSymbol_Cast(sym)->name()->str());
+        else if (sym->kind() == uaiso::Symbol::Kind::Namespace)
+            entry.m_name = intern(ConstNamespace_Cast(sym)->name()->str());
+        else
+            continue;
+        entry.m_kind = static_cast<int>(sym->kind());
+        const std::string& declFileName = sym->sourceLoc().fileName_;
+        if (declFileName.empty() || declFileName == stdFileName)
+            entry.m_distance = topLevel.count(sym) ? FileScope : InnerScope;
+        else if (declFileName.compare(0, dirName.size(), dirName) == 0
+                 && declFileName.find('/', dirName.size()) == std::string::npos)
+            entry.m_distance = PackageScope;
+        else
+            entry.m_distance = ExternalScope;
+        proposals.append(entry);
+    }
+    return proposals;
+}
+
+    //--------------//
+    //--- Stages ---//
+    //--------------//
+
+std::unique_ptr<uaiso::Unit> UaisoQtc::parseSource(uaiso::Factory* factory,
+                                                   const QString& fileName,
+                                                   const std::string& code,
+                                                   uaiso::TokenMap* tokens,
+                                                   uaiso::LexemeMap* lexemes,
+                                                   std::unique_ptr<uaiso::DiagnosticReports>* reports)
+{
+    std::unique_ptr<uaiso::Unit> unit = factory->makeUnit();
+    unit->assignInput(code);
+    unit->setFileName(fileName.toStdString());
+    unit->parse(tokens, lexemes);
+    reports->reset(unit->releaseReports());
+    return unit;
+}
+
+std::unique_ptr<uaiso::Program> UaisoQtc::bindProgram(uaiso::Factory* factory,
+                                                      uaiso::ProgramAst* progAst,
+                                                      const QString& fileName,
+                                                      uaiso::TokenMap* tokens,
+                                                      uaiso::LexemeMap* lexemes,
+                                                      uaiso::DiagnosticReports* reports)
+{
+    uaiso::Binder binder(factory);
+    binder.setLexemes(lexemes);
+    binder.setTokens(tokens);
+    binder.collectDiagnostics(reports);
+    return std::unique_ptr<uaiso::Program>(binder.bind(progAst, fileName.toStdString()));
+}
+
+void UaisoQtc::typeCheck(uaiso::Factory* factory,
+                         uaiso::ProgramAst* progAst,
+                         uaiso::TokenMap* tokens,
+                         uaiso::LexemeMap* lexemes,
+                         uaiso::DiagnosticReports* reports)
+{
+    uaiso::TypeChecker typeChecker(factory);
+    typeChecker.setLexemes(lexemes);
+    typeChecker.setTokens(tokens);
+    typeChecker.collectDiagnostics(reports);
+    typeChecker.check(progAst);
+}
+
+    //----------------//
+    //--- Pipeline ---//
+    //----------------//
+
+AnalysisPipeline::AnalysisPipeline(uaiso::LangId lang, const QStringList& searchPaths)
+    : m_factory(uaiso::FactoryCreator::create(lang))
+    , m_searchPaths(searchPaths)
+    , m_modules(new ModuleStore)
+    , m_deps(new DependencyManager(m_factory.get(), &m_tokens, &m_lexemes,
+                                   m_snapshot, m_modules.get(), m_searchPaths))
+{}
+
+AnalysisPipeline::~AnalysisPipeline()
+{}
+
+AnalysisResult AnalysisPipeline::analyse(const QString& fileName, const std::string& code)
+{
+    AnalysisResult result;
+    const std::string stdFileName = fileName.toStdString();
+
+    m_tokens.clear(stdFileName);
+    m_lexemes.clear(stdFileName);
+
+    std::unique_ptr<uaiso::DiagnosticReports> reports;
+    std::unique_ptr<uaiso::Unit> unit =
+            parseSource(m_factory.get(), fileName, code, &m_tokens, &m_lexemes, &reports);
+
+    uaiso::ProgramAst* progAst = Program_Cast(unit->ast());
+    if (!progAst) {
+        result.m_diagnostics = diagnosticEntries(reports.get());
+        return result;
+    }
+
+    std::unique_ptr<uaiso::Program> prog =
+            bindProgram(m_factory.get(), progAst, fileName, &m_tokens, &m_lexemes, reports.get());
+
+    if (prog && !prog->env().isEmpty()) {
+        result.m_decls = declEntries(prog.get());
+        result.m_imports = importTargets(prog.get());
+        m_snapshot.insertOrReplace(stdFileName, std::move(prog));
+        m_deps->invalidate(fileName);
+        m_deps->processDeps(fileName, result.m_imports);
+
+        typeCheck(m_factory.get(), progAst, &m_tokens, &m_lexemes, reports.get());
+
+        result.m_refs = collectSymbolRefs(m_factory.get(), progAst, &m_lexemes, fileName,
+                                          [this](const QString& declFileName) {
+            return declEntries(m_snapshot.find(declFileName.toStdString()));
+        });
+    }
+
+    result.m_diagnostics = diagnosticEntries(reports.get());
+    return result;
+}
@@ -0,0 +1,381 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_PIPELINE_H
+#define UAISO_QTC_PIPELINE_H
+
+#include "uaisointerner.h"
+
+#include <QDataStream>
+#include <QFuture>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrentRun>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/LangId.h>
+#include <Parsing/LexemeMap.h>
+#include <Parsing/TokenMap.h>
+#include <Semantic/Snapshot.h>
+
+namespace uaiso {
+
+class DiagnosticReports;
+class Factory;
+class Manager;
+class Program;
+class ProgramAst;
+class Unit;
+
+}
+
+// Everything in here depends only on QtCore and the engine, it's shared by
+// the plugin and the out-of-process analyser.
+
+namespace UaisoQtc {
+
+class DependencyManager;
+class ModuleStore;
+
+    //--------------------//
+    //--- Plain results ---//
+    //--------------------//
+
+struct DiagnosticEntry
+{
+    int m_line;
+    int m_col;
+    int m_lastCol;
+    bool m_warning;
+    QString m_desc;
+};
+
+/*!
+ * \brief The SymbolKey struct
+ *
+ * Identity of a symbol across passes and files: its declaring file, the
+ * top-level declaration it's nested in (if any), its name and kind. The
+ * engine doesn't expose nested scopes, so locals and parameters are told
+ * apart by their line within the enclosing declaration; an edit above one
+ * of them inside that declaration re-keys it, but that file's references
+ * are collected again anyway. Edits elsewhere leave keys alone.
+ *
+ * The line and column are where the declaration was when the key was made,
+ * a hint for navigation that isn't part of the identity.
+ */
+struct SymbolKey
+{
+    QString m_fileName;
+    QString m_scope;
+    QString m_name;
+    int m_kind { 0 };
+    int m_offset { 0 };
+
+    int m_line { 0 };
+    int m_col { 0 };
+
+    bool operator==(const SymbolKey& other) const
+    {
+        return m_kind == other.m_kind
+                && m_offset == other.m_offset
+                && isSameString(m_name, other.m_name)
+                && isSameString(m_scope, other.m_scope)
+                && isSameString(m_fileName, other.m_fileName);
+    }
+};
+
+uint qHash(const SymbolKey& key, uint seed = 0);
+
+struct SymbolRef
+{
+    int m_line;
+    int m_col;
+    int m_length;
+    int m_kind;
+    SymbolKey m_key;
+};
+
+struct DeclEntry
+{
+    QString m_name;
+    int m_line;
+    int m_col;
+    int m_kind;
+};
+
+struct ProposalEntry
+{
+    QString m_name;
+    int m_kind;
+    int m_distance; // ScopeDistance.
+};
+
+/*!
+ * \brief The ScopeDistance enum
+ *
+ * How far from the completion point a proposal is declared. The engine
+ * doesn't expose nested scopes, so the file's top-level environment is the
+ * only boundary known within a file.
+ */
+enum ScopeDistance
+{
+    InnerScope,     // Inside a declaration of the file: a parameter, a local.
+    FileScope,      // At the file's top level.
+    PackageScope,   // In a file of the same directory.
+    ExternalScope   // Anywhere else, imported modules and the prelude.
+};
+
+struct AnalysisResult
+{
+    QVector<DiagnosticEntry> m_diagnostics;
+    QVector<SymbolRef> m_refs;
+    QVector<DeclEntry> m_decls;
+    QStringList m_imports; // Dependencies are loaded by whoever applies it.
+};
+
+QDataStream& operator<<(QDataStream& out, const DiagnosticEntry& entry);
+QDataStream& operator>>(QDataStream& in, DiagnosticEntry& entry);
+QDataStream& operator<<(QDataStream& out, const SymbolKey& key);
+QDataStream& operator>>(QDataStream& in, SymbolKey& key);
+QDataStream& operator<<(QDataStream& out, const SymbolRef& ref);
+QDataStream& operator>>(QDataStream& in, SymbolRef& ref);
+QDataStream& operator<<(QDataStream& out, const DeclEntry& entry);
+QDataStream& operator>>(QDataStream& in, DeclEntry& entry);
+QDataStream& operator<<(QDataStream& out, const ProposalEntry& entry);
+QDataStream& operator>>(QDataStream& in, ProposalEntry& entry);
+QDataStream& operator<<(QDataStream& out, const AnalysisResult& result);
+QDataStream& operator>>(QDataStream& in, AnalysisResult& result);
+
+    //--------------------//
+    //--- Cancellation ---//
+    //--------------------//
+
+/*!
+ * \brief The CancellationToken class
+ *
+ * A flag shared by copies of the token. Stages check it between steps and
+ * give up early once it's set, a new token is needed for the next run.
+ */
+class CancellationToken
+{
+public:
+    CancellationToken() : m_canceled(std::make_shared<std::atomic<bool>>(false)) {}
+
+    void cancel() { *m_canceled = true; }
+    bool isCanceled() const { return *m_canceled; }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_canceled;
+};
+
+    //---------------//
+    //--- Helpers ---//
+    //---------------//
+
+void addSearchPaths(uaiso::Manager* manager, const QStringList& paths);
+
+QString sourceSuffix(uaiso::LangId lang);
+
+bool langIdForFile(const QString& fileName, uaiso::LangId* lang);
+
+/*!
+ * \brief contentHash
+ *
+ * FNV-1a of \a fileName and \a text, identifies a state of a document.
+ */
+quint64 contentHash(const QString& fileName, const QString& text);
+
+/*!
+ * \brief mapOn
+ *
+ * Map \a items on \a pool and wait for the results, in order. Unlike
+ * QtConcurrent::blockingMapped, which only knows the global pool, it can
+ * be called from a task of the global pool without starving it.
+ */
+template <class Result, class Sequence, class Func>
+QVector<Result> mapOn(QThreadPool* pool, const Sequence& items, Func func)
+{
+    QList<QFuture<Result>> futures;
+    for (const auto& item : items)
+        futures.append(QtConcurrent::run(pool, [func, item]() { return func(item); }));
+
+    QVector<Result> results;
+    results.reserve(futures.size());
+    for (QFuture<Result>& future : futures)
+        results.append(future.result());
+    return results;
+}
+
+/*!
+ * \brief charColumn
+ *
+ * The engine's columns count UTF-8 bytes of \a line, Qt's count QChars.
+ */
+int charColumn(const std::string& line, int byteCol);
+
+/*!
+ * \brief The MemberEntry struct
+ *
+ * A line one level into a record's body. Member functions have a name and
+ * their header, anything else (a field, say) has its text as the header.
+ */
+struct MemberEntry
+{
+    QString m_name;
+    QString m_header;
+    int m_line;
+    int m_col;
+};
+
+/*!
+ * \brief declarationHeader
+ *
+ * A declaration's text from its name, at column \a col (in QChars) of
+ * \a line, to where its body (or the next statement) starts, the parameter
+ * list included, whatever the language puts around it. Empty if there's
+ * no parameter list.
+ */
+QString declarationHeader(const QStringList& lines, int line, int col);
+
+/*!
+ * \brief recordMembers
+ *
+ * What the body of the record whose header is at \a line declares, up to
+ * \a end, as written. The engine only lists top-level declarations, so
+ * members are found in the text: lines one level in, a name opening a
+ * parameter list and preceded by words only being a member function.
+ */
+QVector<MemberEntry> recordMembers(const QStringList& lines, int line, int end);
+
+QVector<DiagnosticEntry> diagnosticEntries(const uaiso::DiagnosticReports* reports);
+
+QVector<DeclEntry> declEntries(const uaiso::Program* prog);
+
+QStringList importTargets(const uaiso::Program* prog);
+
+/*!
+ * \brief DeclLookup
+ *
+ * The top-level declarations of a file, empty if it isn't known. It tells
+ * which declaration a symbol is nested in, for its SymbolKey.
+ */
+typedef std::function<QVector<DeclEntry> (const QString&)> DeclLookup;
+
+/*!
+ * \brief collectSymbolRefs
+ *
+ * Return nothing if \a token gets canceled on the way. \a decls is
+ * called once per declaring file, from the calling thread.
+ */
+QVector<SymbolRef> collectSymbolRefs(uaiso::Factory* factory,
+                                     uaiso::ProgramAst* progAst,
+                                     const uaiso::LexemeMap* lexemes,
+                                     const QString& fileName,
+                                     const DeclLookup& decls,
+                                     const CancellationToken& token = CancellationToken());
+
+/*!
+ * \brief proposeCompletions
+ *
+ * Run the engine's completion at \a line and \a col (0-based, already
+ * adjusted to the triggering token) against a private snapshot. Nothing
+ * is proposed once \a token is canceled.
+ */
+QVector<ProposalEntry> proposeCompletions(uaiso::Factory* factory,
+                                          const QStringList& searchPaths,
+                                          const std::string& code,
+                                          const QString& fileName,
+                                          int line, int col,
+                                          const CancellationToken& token = CancellationToken());
+
+    //--------------//
+    //--- Stages ---//
+    //--------------//
+
+// The analysis steps, on explicit maps so callers decide what is shared.
+// Diagnostics are appended to \a reports (parseSource creates it).
+
+std::unique_ptr<uaiso::Unit> parseSource(uaiso::Factory* factory,
+                                         const QString& fileName,
+                                         const std::string& code,
+                                         uaiso::TokenMap* tokens,
+                                         uaiso::LexemeMap* lexemes,
+                                         std::unique_ptr<uaiso::DiagnosticReports>* reports);
+
+std::unique_ptr<uaiso::Program> bindProgram(uaiso::Factory* factory,
+                                            uaiso::ProgramAst* progAst,
+                                            const QString& fileName,
+                                            uaiso::TokenMap* tokens,
+                                            uaiso::LexemeMap* lexemes,
+                                            uaiso::DiagnosticReports* reports);
+
+void typeCheck(uaiso::Factory* factory,
+               uaiso::ProgramAst* progAst,
+               uaiso::TokenMap* tokens,
+               uaiso::LexemeMap* lexemes,
+               uaiso::DiagnosticReports* reports);
+
+    //----------------//
+    //--- Pipeline ---//
+    //----------------//
+
+/*!
+ * \brief The AnalysisPipeline class
+ *
+ * Parse, bind, process dependencies, type-check and collect symbols of a
+ * file in one go, keeping its own tokens, lexemes, snapshot and dependency
+ * graph. It's the same sequence documents run in-process, minus the timers.
+ */
+class AnalysisPipeline
+{
+public:
+    AnalysisPipeline(uaiso::LangId lang, const QStringList& searchPaths);
+    ~AnalysisPipeline();
+
+    uaiso::Factory* factory() const { return m_factory.get(); }
+
+    AnalysisResult analyse(const QString& fileName, const std::string& code);
+
+private:
+    std::unique_ptr<uaiso::Factory> m_factory;
+    QStringList m_searchPaths;
+    uaiso::LexemeMap m_lexemes;
+    uaiso::TokenMap m_tokens;
+    uaiso::Snapshot m_snapshot;
+    std::unique_ptr<ModuleStore> m_modules;
+    std::unique_ptr<DependencyManager> m_deps;
+};
+
+} // namespace UaisoQtc
+
+#endif
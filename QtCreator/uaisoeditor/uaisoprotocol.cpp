@@ -0,0 +1,99 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisoprotocol.h"
+
+#include <QDataStream>
+#include <QLocalSocket>
+#include <QSharedMemory>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+using namespace Protocol;
+
+QByteArray Message::serialize() const
+{
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << m_id << static_cast<quint8>(m_kind) << m_lang << m_fileName
+        << m_searchPaths << m_code << m_line << m_col << m_sharedKey << m_size;
+    return data;
+}
+
+Message Message::deserialize(const QByteArray &data)
+{
+    Message msg;
+    quint8 kind;
+    QDataStream in(data);
+    in >> msg.m_id >> kind >> msg.m_lang >> msg.m_fileName >> msg.m_searchPaths
+       >> msg.m_code >> msg.m_line >> msg.m_col >> msg.m_sharedKey >> msg.m_size;
+    msg.m_kind = in.status() == QDataStream::Ok ? static_cast<MessageKind>(kind)
+                                                : MessageKind::Failure;
+    return msg;
+}
+
+void Protocol::writeMessage(QLocalSocket *socket, const Message &msg)
+{
+    const QByteArray& data = msg.serialize();
+    QByteArray frame;
+    QDataStream out(&frame, QIODevice::WriteOnly);
+    out << static_cast<quint32>(data.size());
+    frame.append(data);
+    socket->write(frame);
+}
+
+bool Protocol::readMessage(QLocalSocket *socket, Message *msg)
+{
+    quint32 size;
+    if (socket->bytesAvailable() < static_cast<qint64>(sizeof(size)))
+        return false;
+
+    QByteArray header = socket->peek(sizeof(size));
+    QDataStream(header) >> size;
+    if (socket->bytesAvailable() < static_cast<qint64>(sizeof(size) + size))
+        return false;
+
+    socket->read(sizeof(size));
+    *msg = Message::deserialize(socket->read(size));
+    return true;
+}
+
+bool Protocol::readShared(const Message &msg, QByteArray *data)
+{
+    QSharedMemory shared(msg.m_sharedKey);
+    if (!shared.attach(QSharedMemory::ReadOnly))
+        return false;
+
+    // The size comes from the other side, it's not trusted.
+    const bool fits = msg.m_size >= 0 && msg.m_size <= shared.size();
+    if (fits) {
+        shared.lock();
+        *data = QByteArray(static_cast<const char*>(shared.constData()), msg.m_size);
+        shared.unlock();
+    }
+    shared.detach();
+    return fits;
+}
@@ -0,0 +1,97 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_PROTOCOL_H
+#define UAISO_QTC_PROTOCOL_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+QT_BEGIN_NAMESPACE
+class QLocalSocket;
+QT_END_NAMESPACE
+
+// Messages exchanged between the plugin and the out-of-process analyser,
+// over a local socket. Each message is length-prefixed. Results aren't sent
+// through the socket: the analyser writes them into a shared memory segment
+// and replies with its key, the plugin releases it once read.
+
+namespace UaisoQtc {
+namespace Protocol {
+
+enum class MessageKind : quint8
+{
+    Analyse,
+    Complete,
+    Release,
+    Result,
+    Failure
+};
+
+struct Message
+{
+    quint32 m_id { 0 };
+    MessageKind m_kind { MessageKind::Failure };
+
+    // Requests.
+    qint32 m_lang { 0 };
+    QString m_fileName;
+    QStringList m_searchPaths;
+    QByteArray m_code;
+    qint32 m_line { 0 };
+    qint32 m_col { 0 };
+
+    // Results.
+    QString m_sharedKey;
+    qint32 m_size { 0 };
+
+    QByteArray serialize() const;
+    static Message deserialize(const QByteArray& data);
+};
+
+void writeMessage(QLocalSocket* socket, const Message& msg);
+
+/*!
+ * \brief readMessage
+ *
+ * Extract a complete message from what's available in the socket. Return
+ * false if the message isn't entirely there yet.
+ */
+bool readMessage(QLocalSocket* socket, Message* msg);
+
+/*!
+ * \brief readShared
+ *
+ * Copy a result out of the shared memory segment referred to by \a msg.
+ */
+bool readShared(const Message& msg, QByteArray* data);
+
+} // namespace Protocol
+} // namespace UaisoQtc
+
+#endif
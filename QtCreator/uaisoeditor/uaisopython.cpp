@@ -0,0 +1,390 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisopython.h"
+#include "uaisomappedfile.h"
+#include "uaisopipeline.h"
+#include "uaisoregistry.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+#include <QReadLocker>
+#include <QSaveFile>
+#include <QVector>
+#include <QWriteLocker>
+
+#include <functional>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Ast/Ast.h>
+#include <Parsing/Diagnostic.h>
+#include <Parsing/Factory.h>
+#include <Parsing/LexemeMap.h>
+#include <Parsing/TokenMap.h>
+#include <Parsing/Unit.h>
+#include <Semantic/Program.h>
+#include <Semantic/Symbol.h>
+
+using namespace UaisoQtc;
+
+namespace {
+
+const int kInterpreterTimeout = 10000;
+const quint32 kMagic = 0x55415059; // UAPY
+const quint32 kVersion = 2;
+
+bool stat(const QString& fileName, qint64* size, qint64* modified)
+{
+    const QFileInfo info(fileName);
+    if (!info.exists())
+        return false;
+    *size = info.size();
+    *modified = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+bool startsImport(const QString& line)
+{
+    return line.startsWith(QLatin1String("import "))
+            || line.startsWith(QLatin1String("from "));
+}
+
+/*!
+ * \brief signatureEnd
+ *
+ * The column right after the colon that closes the header starting on
+ * \a line, -1 if there isn't one on that line. Brackets (\a depth) and
+ * strings are followed, so the header may span lines.
+ */
+int signatureEnd(const QString& line, int* depth)
+{
+    QChar quote;
+    for (int i = 0; i < line.size(); ++i) {
+        const QChar c = line.at(i);
+        if (!quote.isNull()) {
+            if (c == QLatin1Char('\\'))
+                ++i;
+            else if (c == quote)
+                quote = QChar();
+            continue;
+        }
+        if (c == QLatin1Char('#'))
+            break;
+        if (c == QLatin1Char('"') || c == QLatin1Char('\''))
+            quote = c;
+        else if (c == QLatin1Char('(') || c == QLatin1Char('[') || c == QLatin1Char('{'))
+            ++*depth;
+        else if (c == QLatin1Char(')') || c == QLatin1Char(']') || c == QLatin1Char('}'))
+            --*depth;
+        else if (c == QLatin1Char(':') && *depth <= 0)
+            return i + 1;
+    }
+    return -1;
+}
+
+int indentOf(const QString& line)
+{
+    int indent = 0;
+    while (indent < line.size() && line.at(indent).isSpace())
+        ++indent;
+    return indent;
+}
+
+/*!
+ * \brief blockEnd
+ *
+ * One past the last line of the block whose header is at \a first: the
+ * next line that is back at the header's indentation, not counting blank
+ * lines, comments, bracketed continuations, and triple-quoted strings.
+ */
+int blockEnd(const QStringList& lines, int first)
+{
+    const int indent = indentOf(lines.at(first));
+    bool inString = false;
+    int depth = 0;
+    signatureEnd(lines.at(first), &depth);
+    int i = first + 1;
+    for (; i < lines.size(); ++i) {
+        const QString& line = lines.at(i);
+        const bool wasInString = inString;
+        if ((line.count(QLatin1String("\"\"\"")) + line.count(QLatin1String("'''"))) % 2)
+            inString = !inString;
+        if (wasInString)
+            continue;
+        if (depth > 0) {
+            signatureEnd(line, &depth);
+            continue;
+        }
+        const QString& trimmed = line.trimmed();
+        if (trimmed.isEmpty() || trimmed.startsWith(QLatin1Char('#')))
+            continue;
+        if (indentOf(line) <= indent)
+            break;
+    }
+    return i;
+}
+
+} // anonymous
+
+QStringList UaisoQtc::interpreterSearchPaths(const QString& interpreter)
+{
+    QProcess process;
+    process.start(interpreter, QStringList() << QLatin1String("-c")
+                  << QLatin1String("import sys; print('\\n'.join(p for p in sys.path if p))"));
+    if (!process.waitForFinished(kInterpreterTimeout)) {
+        process.kill();
+        process.waitForFinished();
+        return QStringList();
+    }
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0)
+        return QStringList();
+
+    // Zipped entries can't be searched.
+    QStringList paths;
+    const QString& output = QString::fromLocal8Bit(process.readAllStandardOutput());
+    for (const QString& line : output.split(QLatin1Char('\n'), QString::SkipEmptyParts)) {
+        const QString& path = QDir::cleanPath(line.trimmed());
+        if (QFileInfo(path).isDir() && !paths.contains(path))
+            paths.append(path);
+    }
+    return paths;
+}
+
+bool UaisoQtc::isSitePackages(const QString& path)
+{
+    const QString& name = QFileInfo(path).fileName();
+    return name == QLatin1String("site-packages") || name == QLatin1String("dist-packages");
+}
+
+PythonStubIndex::PythonStubIndex(LangRegistry* registry)
+    : m_registry(registry)
+{}
+
+PythonStubIndex::~PythonStubIndex()
+{}
+
+bool PythonStubIndex::stub(const QString& fileName, std::string* code) const
+{
+    qint64 size, modified;
+    if (!stat(fileName, &size, &modified))
+        return false;
+
+    QReadLocker locker(&m_lock);
+    auto it = m_entries.constFind(fileName);
+    if (it == m_entries.constEnd()
+            || it->m_stub.isEmpty()
+            || it->m_size != size
+            || it->m_modified != modified) {
+        return false;
+    }
+    *code = it->m_stub.toStdString();
+    return true;
+}
+
+int PythonStubIndex::size() const
+{
+    QReadLocker locker(&m_lock);
+    return m_entries.size();
+}
+
+QByteArray PythonStubIndex::makeStub(const QString& fileName) const
+{
+    MappedFile file(fileName);
+    if (!file.isValid())
+        return QByteArray();
+    const std::string code = file.toStdString();
+    file.release();
+
+    // The language's own factory, which stubs made concurrently share.
+    const std::shared_ptr<uaiso::Factory> factory =
+            m_registry->service(uaiso::LangId::Py)->factory();
+    uaiso::TokenMap tokens;
+    uaiso::LexemeMap lexemes;
+    std::unique_ptr<uaiso::DiagnosticReports> reports;
+    std::unique_ptr<uaiso::Unit> unit =
+            parseSource(factory.get(), fileName, code, &tokens, &lexemes, &reports);
+    uaiso::ProgramAst* progAst = Program_Cast(unit->ast());
+    if (!progAst)
+        return QByteArray();
+    std::unique_ptr<uaiso::Program> prog =
+            bindProgram(factory.get(), progAst, fileName, &tokens, &lexemes, reports.get());
+    if (!prog)
+        return QByteArray();
+
+    const QStringList& lines = QString::fromStdString(code).split(QLatin1Char('\n'));
+    QStringList stub;
+    stub.reserve(lines.size());
+    for (int i = 0; i < lines.size(); ++i)
+        stub.append(QString());
+
+    // Module-level imports as they are, including continuation lines.
+    int depth = 0;
+    bool inImport = false;
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString& line = lines.at(i);
+        if (!inImport && !startsImport(line))
+            continue;
+        stub[i] = line;
+        depth += line.count(QLatin1Char('(')) - line.count(QLatin1Char(')'));
+        inImport = depth > 0 || line.trimmed().endsWith(QLatin1Char('\\'));
+    }
+
+    // Classes are kept whole, members are what completion offers on their
+    // instances. Functions keep their signature, the body is dropped.
+    const QVector<DeclEntry>& decls = declEntries(prog.get());
+    for (const DeclEntry& decl : decls) {
+        if (decl.m_line < 0 || decl.m_line >= stub.size()
+                || static_cast<uaiso::Symbol::Kind>(decl.m_kind) != uaiso::Symbol::Kind::Record) {
+            continue;
+        }
+        const int end = blockEnd(lines, decl.m_line);
+        for (int i = decl.m_line; i < end; ++i)
+            stub[i] = lines.at(i);
+    }
+
+    for (const DeclEntry& decl : decls) {
+        if (decl.m_line < 0 || decl.m_line >= stub.size() || !stub.at(decl.m_line).isEmpty())
+            continue;
+        switch (static_cast<uaiso::Symbol::Kind>(decl.m_kind)) {
+        case uaiso::Symbol::Kind::Func: {
+            int brackets = 0;
+            int line = decl.m_line;
+            int colon = -1;
+            for (; line < lines.size() && colon < 0; ++line) {
+                colon = signatureEnd(lines.at(line), &brackets);
+                stub[line] = colon < 0 ? lines.at(line)
+                                       : lines.at(line).left(colon) + QLatin1String(" pass");
+            }
+            if (colon < 0) {
+                for (int i = decl.m_line + 1; i < line; ++i)
+                    stub[i].clear();
+                stub[decl.m_line] = QLatin1String("def ") + decl.m_name
+                        + QLatin1String("(*args, **kwargs): pass");
+            }
+            break;
+        }
+        case uaiso::Symbol::Kind::Record:
+            break;
+        default:
+            stub[decl.m_line] = decl.m_name + QLatin1String(" = None");
+            break;
+        }
+    }
+
+    return stub.join(QLatin1Char('\n')).toUtf8();
+}
+
+void PythonStubIndex::refresh(const QStringList& dirs,
+                              const QString& cachePath,
+                              const CancellationToken& token)
+{
+    QHash<QString, Entry> cached;
+    QFile in(cachePath);
+    if (in.open(QIODevice::ReadOnly)) {
+        quint32 magic, version;
+        QDataStream header(&in);
+        header >> magic >> version;
+        if (magic == kMagic && version == kVersion) {
+            const QByteArray& payload = qUncompress(in.readAll());
+            QDataStream stream(payload);
+            stream.setVersion(QDataStream::Qt_5_4);
+            quint32 count = 0;
+            stream >> count;
+            for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+                QString fileName;
+                Entry entry;
+                stream >> fileName >> entry.m_size >> entry.m_modified >> entry.m_stub;
+                if (stream.status() == QDataStream::Ok)
+                    cached.insert(fileName, entry);
+            }
+        }
+        in.close();
+    }
+
+    // Unchanged modules are taken from the cache, the others are parsed.
+    QHash<QString, Entry> entries;
+    QStringList stale;
+    for (const QString& dir : dirs) {
+        QDirIterator it(dir, QStringList() << QLatin1String("*.py"),
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            const QString& fileName = it.next();
+            qint64 size, modified;
+            if (!stat(fileName, &size, &modified))
+                continue;
+            auto old = cached.constFind(fileName);
+            if (old != cached.constEnd() && old->m_size == size && old->m_modified == modified)
+                entries.insert(fileName, *old);
+            else
+                stale.append(fileName);
+        }
+    }
+
+    std::function<QPair<QString, Entry> (const QString&)> make =
+            [this, &token](const QString& fileName) {
+        Entry entry;
+        if (token.isCanceled())
+            return qMakePair(fileName, entry);
+        stat(fileName, &entry.m_size, &entry.m_modified);
+        entry.m_stub = makeStub(fileName);
+        return qMakePair(fileName, entry);
+    };
+    // Refreshing runs in the global pool, stubs are made in the index's own.
+    for (const auto& made : mapOn<QPair<QString, Entry>>(&m_pool, stale, make))
+        entries.insert(made.first, made.second);
+    if (token.isCanceled())
+        return;
+
+    const bool changed = !stale.isEmpty() || entries.size() != cached.size();
+    {
+        QWriteLocker locker(&m_lock);
+        m_entries = entries;
+    }
+    if (!changed)
+        return;
+
+    QByteArray payload;
+    QDataStream stream(&payload, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_4);
+    stream << static_cast<quint32>(entries.size());
+    for (auto it = entries.constBegin(); it != entries.constEnd(); ++it)
+        stream << it.key() << it->m_size << it->m_modified << it->m_stub;
+
+    QDir().mkpath(QFileInfo(cachePath).absolutePath());
+    QSaveFile out(cachePath);
+    if (!out.open(QIODevice::WriteOnly))
+        return;
+    QDataStream header(&out);
+    header << kMagic << kVersion;
+    out.write(qCompress(payload));
+    out.commit();
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_PYTHON_H
+#define UAISO_QTC_PYTHON_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QReadWriteLock>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+
+#include <string>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+class CancellationToken;
+class LangRegistry;
+
+/*!
+ * \brief interpreterSearchPaths
+ *
+ * The sys.path of \a interpreter, empty if it can't be run. Blocking.
+ */
+QStringList interpreterSearchPaths(const QString& interpreter);
+
+/*!
+ * \brief isSitePackages
+ *
+ * Whether \a path is where third-party packages are installed.
+ */
+bool isSitePackages(const QString& path);
+
+/*!
+ * \brief The PythonStubIndex class
+ *
+ * Stubs of installed modules: a module's imports, its classes as they are,
+ * and the signatures of its functions, each at its original line, everything
+ * else dropped. Loading
+ * a stub instead of the source makes importing a large library cheap, and
+ * locations still match. Stubs are cached on disk, only modules whose size
+ * or modification time changed are done again.
+ */
+class PythonStubIndex
+{
+public:
+    explicit PythonStubIndex(LangRegistry* registry);
+    ~PythonStubIndex();
+
+    /*!
+     * \brief stub
+     *
+     * The stub of \a fileName, if it's indexed and the file didn't change.
+     * Thread-safe.
+     */
+    bool stub(const QString& fileName, std::string* code) const;
+
+    /*!
+     * \brief refresh
+     *
+     * Bring the index up to date with the modules under \a dirs, the cache
+     * in \a cachePath is read first and written afterwards (unless \a token
+     * gets canceled). Blocking, and meant for a background thread.
+     */
+    void refresh(const QStringList& dirs,
+                 const QString& cachePath,
+                 const CancellationToken& token);
+
+    int size() const;
+
+private:
+    struct Entry
+    {
+        qint64 m_size { 0 };
+        qint64 m_modified { 0 };
+        QByteArray m_stub;
+    };
+
+    QByteArray makeStub(const QString& fileName) const;
+
+    LangRegistry* m_registry;
+    mutable QReadWriteLock m_lock;
+    QHash<QString, Entry> m_entries;
+    QThreadPool m_pool;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -0,0 +1,99 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisoregistry.h"
+
+#include <QMutexLocker>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/Factory.h>
+#include <Parsing/Lang.h>
+
+#include <algorithm>
+
+using namespace UaisoQtc;
+
+    //-------------------//
+    //--- LangService ---//
+    //-------------------//
+
+LangService::LangService(uaiso::LangId langId)
+    : m_langId(langId)
+    , m_factory(uaiso::FactoryCreator::create(langId))
+    , m_lang(m_factory->makeLang())
+    , m_maxActivationSeqLength(0)
+{
+    for (const std::string& seq : { m_lang->funcCallDelim(),
+                                    m_lang->memberAccessOprtr(),
+                                    m_lang->packageSeparator() }) {
+        if (seq.empty())
+            continue;
+        m_activationSeqs.append(QString::fromStdString(seq));
+        m_maxActivationSeqLength = std::max(m_maxActivationSeqLength,
+                                            static_cast<int>(seq.size()));
+    }
+    m_activationSeqs.removeDuplicates();
+
+    // Only what the language imports implicitly. The rest of the system
+    // paths (a whole standard library, typically) isn't preloaded, modules
+    // there are loaded when a file imports them.
+    switch (langId) {
+    case uaiso::LangId::D:
+        m_prelude << QLatin1String("object");
+        break;
+    case uaiso::LangId::Go:
+        m_prelude << QLatin1String("builtin");
+        break;
+    case uaiso::LangId::Py:
+        m_prelude << QLatin1String("builtins") << QLatin1String("__builtin__");
+        break;
+    default:
+        break;
+    }
+}
+
+LangService::~LangService()
+{}
+
+    //--------------------//
+    //--- LangRegistry ---//
+    //--------------------//
+
+LangRegistry::LangRegistry()
+{}
+
+LangRegistry::~LangRegistry()
+{}
+
+const LangService* LangRegistry::service(uaiso::LangId langId)
+{
+    QMutexLocker locker(&m_mutex);
+    std::unique_ptr<LangService>& service = m_services[static_cast<int>(langId)];
+    if (!service)
+        service.reset(new LangService(langId));
+    return service.get();
+}
@@ -0,0 +1,115 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_REGISTRY_H
+#define UAISO_QTC_REGISTRY_H
+
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+#include <memory>
+#include <unordered_map>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+#include <Parsing/LangId.h>
+
+namespace uaiso {
+
+class Factory;
+class Lang;
+
+}
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The LangService class
+ *
+ * What's needed about a language and never changes: its factory, its Lang,
+ * and the activation sequences completion checks on every keystroke. It's
+ * shared by documents, assist processors and dependency managers, from any
+ * thread.
+ *
+ * That includes the factory: a uaiso::Factory holds no state, it only makes
+ * objects (units, lexers, builders) for the caller to own, so the
+ * loader's pool, completion and preview workers, and the GUI thread all use
+ * the same one. What it makes isn't shared.
+ */
+class LangService
+{
+public:
+    explicit LangService(uaiso::LangId langId);
+    ~LangService();
+
+    uaiso::LangId langId() const { return m_langId; }
+    std::shared_ptr<uaiso::Factory> factory() const { return m_factory; }
+    const uaiso::Lang* lang() const { return m_lang.get(); }
+
+    const QStringList& activationSequences() const { return m_activationSeqs; }
+    int maxActivationSequenceLength() const { return m_maxActivationSeqLength; }
+
+    /*!
+     * \brief preludeModules
+     *
+     * Modules every file of the language implicitly depends on. These are
+     * names, not files: they're resolved against the configured system
+     * paths (and the interpreter's, for Python) when loaded, so a prelude
+     * that isn't installed there is simply not loaded.
+     */
+    const QStringList& preludeModules() const { return m_prelude; }
+
+private:
+    uaiso::LangId m_langId;
+    std::shared_ptr<uaiso::Factory> m_factory;
+    std::unique_ptr<uaiso::Lang> m_lang;
+    QStringList m_activationSeqs;
+    int m_maxActivationSeqLength;
+    QStringList m_prelude;
+};
+
+/*!
+ * \brief The LangRegistry class
+ *
+ * Lazily builds, and then keeps, one LangService per language.
+ */
+class LangRegistry
+{
+public:
+    LangRegistry();
+    ~LangRegistry();
+
+    const LangService* service(uaiso::LangId langId);
+
+private:
+    QMutex m_mutex;
+    std::unordered_map<int, std::unique_ptr<LangService>> m_services;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -0,0 +1,293 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#include "uaisoremote.h"
+#include "uaisoeditor.h"
+#include "uaisoprotocol.h"
+
+#include <coreplugin/icore.h>
+#include <utils/hostosinfo.h>
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QTimer>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+using namespace Protocol;
+
+namespace {
+
+const int kRestartDelay = 1000;
+const int kMaxRestarts = 5;
+const int kCompletionTimeout = 5000;
+const int kAnalysisTimeout = 30000;
+const int kWatchdogInterval = 1000;
+
+QString analyserPath()
+{
+    return Core::ICore::libexecPath() + QLatin1String("/")
+            + Utils::HostOsInfo::withExecutableSuffix(QLatin1String("uaisoanalyser"));
+}
+
+// The segment goes whether the result could be read or not.
+void release(QLocalSocket* socket, const Message& reply)
+{
+    if (reply.m_kind != MessageKind::Result)
+        return;
+
+    Message msg;
+    msg.m_id = reply.m_id;
+    msg.m_kind = MessageKind::Release;
+    msg.m_sharedKey = reply.m_sharedKey;
+    writeMessage(socket, msg);
+}
+
+} // anonymous
+
+UaisoRemoteAnalyser::UaisoRemoteAnalyser(QObject *parent)
+    : QObject(parent)
+    , m_enabled(false)
+    , m_running(false)
+    , m_restarts(0)
+    , m_blameless(false)
+    , m_serverName(QString::fromLatin1("uaiso-analyser-%1")
+                   .arg(QCoreApplication::applicationPid()))
+    , m_nextId(1)
+{
+    connect(&m_process, SIGNAL(readyReadStandardOutput()), this, SLOT(readReady()));
+    connect(&m_process, SIGNAL(finished(int,QProcess::ExitStatus)),
+            this, SLOT(processFinished(int,QProcess::ExitStatus)));
+    connect(&m_socket, SIGNAL(readyRead()), this, SLOT(readReplies()));
+
+    m_watchdog.setInterval(kWatchdogInterval);
+    connect(&m_watchdog, SIGNAL(timeout()), this, SLOT(checkDeadlines()));
+}
+
+UaisoRemoteAnalyser::~UaisoRemoteAnalyser()
+{
+    m_enabled = false;
+    stop();
+}
+
+void UaisoRemoteAnalyser::setEnabled(bool enabled)
+{
+    if (m_enabled == enabled)
+        return;
+
+    m_enabled = enabled;
+    m_restarts = 0;
+    if (m_enabled)
+        start();
+    else
+        stop();
+}
+
+bool UaisoRemoteAnalyser::isRunning() const
+{
+    return m_running;
+}
+
+void UaisoRemoteAnalyser::start()
+{
+    if (!m_enabled || m_process.state() != QProcess::NotRunning)
+        return;
+
+    m_process.start(analyserPath(), QStringList() << m_serverName);
+}
+
+void UaisoRemoteAnalyser::stop()
+{
+    m_running = false;
+    failPending(false);
+    m_socket.abort();
+    if (m_process.state() != QProcess::NotRunning) {
+        m_process.kill();
+        m_process.waitForFinished();
+    }
+}
+
+void UaisoRemoteAnalyser::failPending(bool crashed)
+{
+    m_watchdog.stop();
+    QMap<quint32, Pending> pending;
+    pending.swap(m_pending);
+
+    // Requests are answered in order, the oldest is what the analyser was
+    // working on. The others didn't get a chance.
+    for (auto it = pending.begin(); it != pending.end(); ++it) {
+        const bool culprit = crashed && it == pending.begin();
+        it->m_handler(culprit ? Crashed : Unavailable, AnalysisResult());
+    }
+}
+
+void UaisoRemoteAnalyser::checkDeadlines()
+{
+    if (m_pending.isEmpty()) {
+        m_watchdog.stop();
+        return;
+    }
+
+    if (m_pending.first().m_elapsed.hasExpired(kAnalysisTimeout))
+        m_process.kill();
+}
+
+void UaisoRemoteAnalyser::killHung()
+{
+    // A completion timed out, pending analyses aren't to blame.
+    if (m_process.state() == QProcess::NotRunning)
+        return;
+    m_blameless = true;
+    m_process.kill();
+}
+
+void UaisoRemoteAnalyser::readReady()
+{
+    // The analyser tells it's listening by writing a single line.
+    m_process.readAllStandardOutput();
+    if (m_running)
+        return;
+
+    m_socket.connectToServer(m_serverName);
+    m_running = m_socket.waitForConnected();
+}
+
+void UaisoRemoteAnalyser::processFinished(int, QProcess::ExitStatus)
+{
+    m_running = false;
+    m_socket.abort();
+    failPending(!m_blameless);
+    m_blameless = false;
+
+    if (m_enabled && m_restarts < kMaxRestarts) {
+        ++m_restarts;
+        QTimer::singleShot(kRestartDelay, this, SLOT(start()));
+    }
+}
+
+void UaisoRemoteAnalyser::analyse(uaiso::LangId lang,
+                                  const QString &fileName,
+                                  const QByteArray &code,
+                                  AnalysisHandler handler)
+{
+    if (!m_running) {
+        handler(Unavailable, AnalysisResult());
+        return;
+    }
+
+    Message msg;
+    msg.m_id = static_cast<quint32>(m_nextId.fetchAndAddRelaxed(1));
+    msg.m_kind = MessageKind::Analyse;
+    msg.m_lang = static_cast<qint32>(lang);
+    msg.m_fileName = fileName;
+    msg.m_searchPaths = searchPathsFor(lang);
+    msg.m_code = code;
+
+    Pending& pending = m_pending[msg.m_id];
+    pending.m_handler = handler;
+    pending.m_elapsed.start();
+    if (!m_watchdog.isActive())
+        m_watchdog.start();
+
+    writeMessage(&m_socket, msg);
+}
+
+void UaisoRemoteAnalyser::readReplies()
+{
+    Message reply;
+    while (readMessage(&m_socket, &reply)) {
+        QByteArray data;
+        const bool ok = reply.m_kind == MessageKind::Result && readShared(reply, &data);
+        release(&m_socket, reply);
+
+        AnalysisHandler handler = m_pending.take(reply.m_id).m_handler;
+        if (m_pending.isEmpty())
+            m_watchdog.stop();
+        if (!handler)
+            continue;
+        if (!ok) {
+            handler(Unavailable, AnalysisResult());
+            continue;
+        }
+
+        AnalysisResult result;
+        QDataStream in(data);
+        in >> result;
+        m_restarts = 0;
+        handler(Analysed, result);
+    }
+}
+
+bool UaisoRemoteAnalyser::complete(uaiso::LangId lang,
+                                   const QString &fileName,
+                                   const QStringList &searchPaths,
+                                   const QByteArray &code,
+                                   int line, int col,
+                                   QVector<ProposalEntry> *proposals)
+{
+    if (!m_running)
+        return false;
+
+    QElapsedTimer elapsed;
+    elapsed.start();
+    QLocalSocket socket;
+    socket.connectToServer(m_serverName);
+    if (!socket.waitForConnected(kCompletionTimeout))
+        return false;
+
+    Message msg;
+    msg.m_id = static_cast<quint32>(m_nextId.fetchAndAddRelaxed(1));
+    msg.m_kind = MessageKind::Complete;
+    msg.m_lang = static_cast<qint32>(lang);
+    msg.m_fileName = fileName;
+    msg.m_searchPaths = searchPaths;
+    msg.m_code = code;
+    msg.m_line = line;
+    msg.m_col = col;
+    writeMessage(&socket, msg);
+
+    // The whole exchange has a deadline, past it the analyser is restarted.
+    Message reply;
+    while (!readMessage(&socket, &reply)) {
+        const qint64 remaining = kCompletionTimeout - elapsed.elapsed();
+        if (remaining <= 0 || !socket.waitForReadyRead(static_cast<int>(remaining))) {
+            if (socket.state() == QLocalSocket::ConnectedState)
+                QMetaObject::invokeMethod(this, "killHung", Qt::QueuedConnection);
+            return false;
+        }
+    }
+
+    QByteArray data;
+    const bool ok = reply.m_kind == MessageKind::Result && readShared(reply, &data);
+    release(&socket, reply);
+    socket.waitForBytesWritten(kCompletionTimeout);
+    if (!ok)
+        return false;
+
+    QDataStream in(data);
+    in >> *proposals;
+    return true;
+}
@@ -0,0 +1,133 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+#ifndef UAISO_QTC_REMOTE_H
+#define UAISO_QTC_REMOTE_H
+
+#include "uaisopipeline.h"
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QMap>
+#include <QObject>
+#include <QProcess>
+#include <QTimer>
+
+#include <atomic>
+#include <functional>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The UaisoRemoteAnalyser class
+ *
+ * Launches and talks to the out-of-process analyser. When it isn't running
+ * (disabled, not installed, or restarting after a crash) callers are
+ * expected to use the in-process path.
+ *
+ * Requests have a deadline: an analyser that doesn't answer in time is
+ * killed and restarted, as if it had crashed.
+ */
+class UaisoRemoteAnalyser : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Outcome
+    {
+        Analysed,
+        Unavailable,    // Not running, or the request couldn't be answered.
+        Crashed         // The analyser died, or hung, on this request.
+    };
+
+    typedef std::function<void (Outcome, const AnalysisResult&)> AnalysisHandler;
+
+    UaisoRemoteAnalyser(QObject *parent = 0);
+    ~UaisoRemoteAnalyser();
+
+    void setEnabled(bool enabled);
+    bool isRunning() const;
+
+    /*!
+     * \brief analyse
+     *
+     * Asynchronous, must be called from the GUI thread. The \a handler is
+     * called exactly once.
+     */
+    void analyse(uaiso::LangId lang,
+                 const QString& fileName,
+                 const QByteArray& code,
+                 AnalysisHandler handler);
+
+    /*!
+     * \brief complete
+     *
+     * Blocking, meant for the completion thread. It uses a connection of its
+     * own, so it's safe to call from any thread. \a searchPaths must be taken
+     * by the caller, settings can't be read from here.
+     */
+    bool complete(uaiso::LangId lang,
+                  const QString& fileName,
+                  const QStringList& searchPaths,
+                  const QByteArray& code,
+                  int line, int col,
+                  QVector<ProposalEntry>* proposals);
+
+private slots:
+    void start();
+    void readReady();
+    void readReplies();
+    void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void checkDeadlines();
+    void killHung();
+
+private:
+    struct Pending
+    {
+        AnalysisHandler m_handler;
+        QElapsedTimer m_elapsed;
+    };
+
+    void stop();
+    void failPending(bool crashed);
+
+    bool m_enabled;
+    std::atomic<bool> m_running;
+    int m_restarts;
+    bool m_blameless;
+    QString m_serverName;
+    QProcess m_process;
+    QLocalSocket m_socket;
+    QAtomicInt m_nextId;
+    QMap<quint32, Pending> m_pending; // Oldest first.
+    QTimer m_watchdog;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -0,0 +1,131 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisosession.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+using namespace UaisoQtc;
+
+namespace {
+
+const quint32 kMagic = 0x55415343; // UASC
+const quint32 kVersion = 3; // Results carry imports.
+
+bool stat(const QString& fileName, qint64* size, qint64* modified)
+{
+    const QFileInfo info(fileName);
+    if (!info.exists())
+        return false;
+    *size = info.size();
+    *modified = info.lastModified().toMSecsSinceEpoch();
+    return true;
+}
+
+} // anonymous
+
+void SessionCache::record(const QString &fileName, quint64 key, const AnalysisResult &result)
+{
+    Entry entry;
+    if (!stat(fileName, &entry.m_size, &entry.m_modified))
+        return;
+    entry.m_fileName = fileName;
+    entry.m_key = key;
+    entry.m_result = result;
+    m_entries.insert(fileName, entry);
+}
+
+bool SessionCache::save(const QString &path) const
+{
+    QByteArray payload;
+    QDataStream out(&payload, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_4);
+    out << static_cast<quint32>(m_entries.size());
+    for (const Entry& entry : m_entries) {
+        out << entry.m_fileName << entry.m_size << entry.m_modified
+            << entry.m_key << entry.m_result;
+    }
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream header(&file);
+    header << kMagic << kVersion;
+    file.write(qCompress(payload));
+    return file.commit();
+}
+
+QVector<SessionCache::Entry> SessionCache::restore(const QString &path)
+{
+    m_entries.clear();
+
+    QVector<Entry> entries;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return entries;
+
+    quint32 magic, version;
+    QDataStream header(&file);
+    header >> magic >> version;
+    if (magic != kMagic || version != kVersion)
+        return entries;
+
+    const QByteArray& payload = qUncompress(file.readAll());
+    QDataStream in(payload);
+    in.setVersion(QDataStream::Qt_5_4);
+    quint32 count = 0;
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        in >> entry.m_fileName >> entry.m_size >> entry.m_modified
+           >> entry.m_key >> entry.m_result;
+        if (in.status() != QDataStream::Ok)
+            break;
+
+        qint64 size, modified;
+        if (!stat(entry.m_fileName, &size, &modified)
+                || size != entry.m_size || modified != entry.m_modified) {
+            continue;
+        }
+        m_entries.insert(entry.m_fileName, entry);
+        entries.append(entry);
+    }
+    return entries;
+}
+
+void SessionCache::clear()
+{
+    m_entries.clear();
+}
@@ -0,0 +1,86 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#ifndef UAISO_QTC_SESSION_H
+#define UAISO_QTC_SESSION_H
+
+#include "uaisopipeline.h"
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+namespace UaisoQtc {
+
+/*!
+ * \brief The SessionCache class
+ *
+ * Last analysis of every file, as it is on disk, kept across restarts.
+ * Restored entries feed the result cache and the indexes, so reopening a
+ * session shows highlighting and diagnostics without analysing anything.
+ * An entry is dropped once its file's size or modification time change.
+ */
+class SessionCache
+{
+public:
+    struct Entry
+    {
+        QString m_fileName;
+        qint64 m_size { 0 };
+        qint64 m_modified { 0 };
+        quint64 m_key { 0 };
+        AnalysisResult m_result;
+    };
+
+    /*!
+     * \brief record
+     *
+     * Must be called only when the analysed text is that of the file on
+     * disk (the document isn't modified).
+     */
+    void record(const QString& fileName, quint64 key, const AnalysisResult& result);
+
+    bool save(const QString& path) const;
+
+    /*!
+     * \brief restore
+     *
+     * Replace the entries by those in \a path which are still fresh, and
+     * return them.
+     */
+    QVector<Entry> restore(const QString& path);
+
+    void clear();
+
+private:
+    QHash<QString, Entry> m_entries;
+};
+
+} // namespace UaisoQtc
+
+#endif
@@ -20,6 +20,8 @@
 #include "ui_uaisosettings.h"
 #include "uaisosettings.h"
 #include "uaisoeditor.h"
+#include "uaisocompletion.h"
+#include "uaisoremote.h"
 
 #include <coreplugin/icore.h>
 
@@ -106,6 +108,12 @@ void UaisoSettingsPage::apply()
 
     settingsFromUI();
     m_d->m_settings.store(Core::ICore::settings());
+    UaisoEditorPlugin::instance()->resetDependencyManagers();
+    UaisoEditorPlugin::instance()->updatePythonEnvironment();
+    UaisoEditorPlugin::instance()->updateGoIndex();
+    UaisoEditorPlugin::instance()->remoteAnalyser()->setEnabled(m_d->m_settings.m_outOfProcess);
+    UaisoEditorPlugin::instance()->setLargeFileThreshold(m_d->m_settings.m_largeFileThreshold);
+    UaisoEditorPlugin::instance()->completionScheduler()->setBudget(m_d->m_settings.m_completionBudget);
 }
 
 void UaisoSettingsPage::finish()
@@ -144,11 +152,17 @@ void UaisoSettingsPage::updateOptionsOfLang(int index)
 void UaisoSettingsPage::settingsFromUI()
 {
     updateOptionsOfLang(m_d->m_page->langCombo->currentIndex());
+    m_d->m_settings.m_outOfProcess = m_d->m_page->outOfProcessCheck->isChecked();
+    m_d->m_settings.m_largeFileThreshold = m_d->m_page->largeFileSpin->value();
+    m_d->m_settings.m_completionBudget = m_d->m_page->completionBudgetSpin->value();
 }
 
 void UaisoSettingsPage::settingsToUI()
 {
     displayOptionsForLang(m_d->m_page->langCombo->currentIndex());
+    m_d->m_page->outOfProcessCheck->setChecked(m_d->m_settings.m_outOfProcess);
+    m_d->m_page->largeFileSpin->setValue(m_d->m_settings.m_largeFileThreshold);
+    m_d->m_page->completionBudgetSpin->setValue(m_d->m_settings.m_completionBudget);
 }
 
 namespace {
@@ -158,6 +172,9 @@ const QLatin1String kEnabled("Enabled");
 const QLatin1String kInterpreter("Interpreter");
 const QLatin1String kSystemPaths("SystemPaths");
 const QLatin1String kExtraPaths("ExtraPaths");
+const QLatin1String kOutOfProcess("OutOfProcess");
+const QLatin1String kLargeFileThreshold("LargeFileThreshold");
+const QLatin1String kCompletionBudget("CompletionBudget");
 
 } // anonymous
 
@@ -175,6 +192,12 @@ void UaisoSettings::store(QSettings *settings,
 
 void UaisoSettings::store(QSettings *settings) const
 {
+    settings->beginGroup(kUaiso);
+    settings->setValue(kOutOfProcess, m_outOfProcess);
+    settings->setValue(kLargeFileThreshold, m_largeFileThreshold);
+    settings->setValue(kCompletionBudget, m_completionBudget);
+    settings->endGroup();
+
     for (auto const& option : m_options) {
         store(settings,
                       option.second,
@@ -196,6 +219,12 @@ void UaisoSettings::load(QSettings *settings,
 
 void UaisoSettings::load(QSettings *settings)
 {
+    settings->beginGroup(kUaiso);
+    m_outOfProcess = settings->value(kOutOfProcess).toBool();
+    m_largeFileThreshold = settings->value(kLargeFileThreshold, m_largeFileThreshold).toInt();
+    m_completionBudget = settings->value(kCompletionBudget, m_completionBudget).toInt();
+    settings->endGroup();
+
     for (auto lang : availableLangs()) {
         auto& option = m_options[static_cast<int>(lang)];
         load(settings,
@@ -51,6 +51,9 @@ struct UaisoSettings
     };
 
     std::unordered_map<int, LangOptions> m_options;
+    bool m_outOfProcess { false };
+    int m_largeFileThreshold { 1024 }; // KB
+    int m_completionBudget { 150 }; // Milliseconds
 
     void store(QSettings *s) const;
     void store(QSettings *s, const LangOptions& options, const QString& group) const;
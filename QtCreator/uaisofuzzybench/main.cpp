@@ -0,0 +1,133 @@
+/******************************************************************************
+ * Copyright (c) 2014-2015 Leandro T. C. Melo (ltcmelo@gmail.com)
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301
+ * USA
+ *****************************************************************************/
+
+
+#include "uaisofuzzymatcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+    /* Uaiso - https://github.com/ltcmelo/uaiso
+     *
+     * Notice: This implementation has the only purpose of showcasing a few
+     * components of the Uaiso project. It's not intended to be efficient,
+     * nor to be taken as reference on how to write Qt Creator editors. It's
+     * not even complete. The primary concern is to demonstrate Uaiso's API.
+     */
+
+// Times FuzzyMatcher::rank over synthetic completion candidates, names made
+// of identifier-like words in camelCase and snake_case, the way a large
+// module's (or a package's) symbols look. The completion popup asks for the
+// top 100, within a budget of 1 ms over 50k candidates.
+
+using namespace UaisoQtc;
+
+namespace {
+
+const size_t kDefaultCandidates = 50000;
+const size_t kTopN = 100;
+const int kRuns = 50;
+const double kBudgetMs = 1.0;
+
+const char* const kWords[] = {
+    "get", "set", "value", "node", "type", "name", "list", "index", "file",
+    "parse", "bind", "check", "symbol", "scope", "token", "lexeme", "module",
+    "import", "decl", "expr", "stmt", "path", "buffer", "cache", "load",
+    "store", "key", "map", "entry", "item", "count", "size", "first", "last",
+    "next", "prev", "open", "close", "read", "write", "find", "insert",
+    "remove", "update", "build", "make", "create", "reset", "clear", "init"
+};
+const size_t kNumWords = sizeof(kWords) / sizeof(kWords[0]);
+
+// Deterministic, so runs are comparable.
+struct Random
+{
+    unsigned m_state { 12345u };
+    unsigned next(unsigned bound)
+    {
+        m_state = m_state * 1103515245u + 12345u;
+        return (m_state >> 16) % bound;
+    }
+};
+
+std::string makeName(Random* random)
+{
+    const bool snake = random->next(3) == 0;
+    const unsigned parts = 1 + random->next(4);
+    std::string name;
+    for (unsigned i = 0; i < parts; ++i) {
+        std::string word = kWords[random->next(kNumWords)];
+        if (i > 0) {
+            if (snake)
+                name += '_';
+            else
+                word[0] = static_cast<char>(word[0] - 'a' + 'A');
+        }
+        name += word;
+    }
+    if (random->next(5) == 0)
+        name += static_cast<char>('0' + random->next(10));
+    return name;
+}
+
+} // anonymous
+
+int main(int argc, char* argv[])
+{
+    size_t candidates = kDefaultCandidates;
+    if (argc > 1)
+        candidates = static_cast<size_t>(std::strtoul(argv[1], nullptr, 10));
+
+    Random random;
+    FuzzyMatcher matcher;
+    matcher.reserve(candidates);
+    for (size_t i = 0; i < candidates; ++i)
+        matcher.add(makeName(&random), random.next(4), random.next(4));
+
+    const char* const patterns[] = {
+        "", "g", "x", "gv", "getVal", "gsn", "parse_s", "ldmod", "symbolscope", "zq"
+    };
+
+    std::cout << candidates << " candidates, top " << kTopN
+              << ", best of " << kRuns << " runs" << std::endl;
+    bool withinBudget = true;
+    for (const char* pattern : patterns) {
+        double best = 1e9;
+        size_t matched = 0;
+        for (int run = 0; run < kRuns; ++run) {
+            const auto start = std::chrono::steady_clock::now();
+            matched = matcher.rank(pattern, kTopN).size();
+            const std::chrono::duration<double, std::milli> elapsed =
+                    std::chrono::steady_clock::now() - start;
+            best = std::min(best, elapsed.count());
+        }
+        withinBudget = withinBudget && best < kBudgetMs;
+        std::cout << "  \"" << pattern << "\": " << best << " ms, "
+                  << matched << " ranked" << std::endl;
+    }
+
+    std::cout << (withinBudget ? "within" : "over") << " the " << kBudgetMs
+              << " ms budget" << std::endl;
+    return withinBudget ? 0 : 1;
+}
@@ -0,0 +1,16 @@
+CONFIG += console
+CONFIG -= app_bundle qt
+
+TARGET = uaisofuzzybench
+
+UAISOEDITOR_DIR = $$PWD/../../plugins/uaisoeditor
+INCLUDEPATH += $$UAISOEDITOR_DIR
+
+include(../../qtcreatortool.pri)
+
+HEADERS += \
+    $$UAISOEDITOR_DIR/uaisofuzzymatcher.h
+
+SOURCES += \
+    main.cpp \
+    $$UAISOEDITOR_DIR/uaisofuzzymatcher.cpp